@@ -0,0 +1,333 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+
+// ============================================================================
+// LESSON: SHARDED (STRIPED) COUNTER
+// ============================================================================
+/*
+THE PROBLEM WITH SafeCounter (demo_005.cpp):
+- Every increment() takes the SAME std::mutex
+- Every increment() writes the SAME cache line (the mutex and the int)
+- With N threads incrementing, all N cores fight over one cache line
+- Result: adding threads makes the counter SLOWER, not faster
+
+A single std::atomic<int> with fetch_add() removes the mutex, but the
+cache line still bounces between cores on every increment.
+
+THE SOLUTION: SHARDING
+- Split the counter into several SLOTS (shards)
+- Each thread increments only ITS OWN slot
+- Each slot lives on its OWN cache line (padding) -> no false sharing
+- Reading the total means summing all slots (reads are rare, writes are hot)
+
+TRADE-OFF:
+- increment():  very cheap, scales with the number of cores
+- getCount():   more expensive (visits every slot)
+- Best for statistics counters: written constantly, read occasionally
+*/
+
+// Size of one cache line on practically every x86-64 and ARM64 CPU
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+// ============================================================================
+// BASELINE 1: Mutex Counter (same design as SafeCounter in demo_005.cpp)
+// ============================================================================
+class SafeCounter {
+private:
+    mutable std::mutex mtx;
+    long count;
+
+public:
+    SafeCounter() : count(0) {}
+
+    void increment() {
+        std::lock_guard<std::mutex> lock(mtx);
+        ++count;
+    }
+
+    void decrement() {
+        std::lock_guard<std::mutex> lock(mtx);
+        --count;
+    }
+
+    long getCount() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return count;
+    }
+
+    long incrementAndGet() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return ++count;
+    }
+};
+
+// ============================================================================
+// BASELINE 2: Single Atomic Counter
+// ============================================================================
+// No mutex, but every thread still writes the same cache line
+class AtomicCounter {
+private:
+    std::atomic<long> count{0};
+
+public:
+    void increment() { count.fetch_add(1, std::memory_order_relaxed); }
+    void decrement() { count.fetch_sub(1, std::memory_order_relaxed); }
+    long getCount() const { return count.load(std::memory_order_relaxed); }
+    long incrementAndGet() { return count.fetch_add(1) + 1; }
+};
+
+// ============================================================================
+// GOOD EXAMPLE: Sharded Counter with Cache-Line Padded Slots
+// ============================================================================
+class ShardedCounter {
+private:
+    // One slot per shard, aligned so that no two slots share a cache line
+    // Without alignas, 8 slots of 8 bytes would all sit in ONE cache line
+    // and we would be back to the single-atomic problem (false sharing)
+    struct alignas(CACHE_LINE_SIZE) PaddedSlot {
+        std::atomic<long> value{0};
+    };
+
+    std::unique_ptr<PaddedSlot[]> slots;
+    std::size_t mask;  // numShards - 1 (numShards is a power of two)
+
+    // Serializes the exact slow path (incrementAndGet) only
+    std::mutex slowPathMtx;
+
+    // Round up to the next power of two so we can use (index & mask)
+    static std::size_t roundUpPow2(std::size_t n) {
+        std::size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    // Each thread gets a small index the first time it touches ANY counter
+    // Threads are spread round-robin over the slots
+    static std::size_t threadIndex() {
+        static std::atomic<std::size_t> nextIndex{0};
+        thread_local const std::size_t index = nextIndex.fetch_add(1);
+        return index;
+    }
+
+    PaddedSlot& mySlot() {
+        return slots[threadIndex() & mask];
+    }
+
+public:
+    // Default: one shard per hardware thread
+    explicit ShardedCounter(std::size_t numShards = std::thread::hardware_concurrency())
+        : slots(nullptr), mask(0) {
+        std::size_t n = roundUpPow2(std::max<std::size_t>(numShards, 1));
+        slots.reset(new PaddedSlot[n]);
+        mask = n - 1;
+    }
+
+    // Copying would copy a snapshot of atomics - forbid it like SafeLogger does
+    ShardedCounter(const ShardedCounter&) = delete;
+    ShardedCounter& operator=(const ShardedCounter&) = delete;
+
+    // FAST PATH: touches only this thread's own cache line
+    // relaxed is enough: we only need the increment itself to be atomic
+    void increment() {
+        mySlot().value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void decrement() {
+        mySlot().value.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // MERGING READ: sum every slot
+    // While other threads are incrementing, the result is a value the counter
+    // passed through while we were summing (never a torn/garbage value)
+    long getCount() const {
+        long total = 0;
+        for (std::size_t i = 0; i <= mask; ++i) {
+            total += slots[i].value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    // EXACT SLOW PATH: increment and return the resulting total
+    // - Callers of incrementAndGet() are serialized by slowPathMtx, so for
+    //   an increment-only counter every caller gets a UNIQUE, increasing value
+    // - The result includes every increment that happened-before this call
+    // Use this for IDs/tickets; use increment() for statistics
+    long incrementAndGet() {
+        std::lock_guard<std::mutex> lock(slowPathMtx);
+        mySlot().value.fetch_add(1, std::memory_order_seq_cst);
+        long total = 0;
+        for (std::size_t i = 0; i <= mask; ++i) {
+            total += slots[i].value.load(std::memory_order_seq_cst);
+        }
+        return total;
+    }
+
+    std::size_t shardCount() const { return mask + 1; }
+};
+
+// ============================================================================
+// BENCHMARK HELPER
+// ============================================================================
+// Runs numThreads threads, each calling increment() opsPerThread times
+// Returns throughput in millions of operations per second
+template <typename Counter>
+double measureIncrements(Counter& counter, unsigned numThreads, long opsPerThread) {
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&counter, &go, opsPerThread]() {
+            // Wait for the start signal so all threads begin together
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (long i = 0; i < opsPerThread; ++i) {
+                counter.increment();
+            }
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) t.join();
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return (numThreads * opsPerThread) / seconds / 1e6;
+}
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: Same workload as demo6_safe_counter in demo_005.cpp
+void demo1_sharded_counter() {
+    std::cout << "\n=== DEMO 1: Sharded Counter (2 threads x 10000) ===" << std::endl;
+
+    ShardedCounter counter;
+
+    auto incrementTask = [&counter]() {
+        for (int i = 0; i < 10000; ++i) {
+            counter.increment();
+        }
+    };
+
+    std::thread t1(incrementTask);
+    std::thread t2(incrementTask);
+
+    t1.join();
+    t2.join();
+
+    std::cout << "Shards: " << counter.shardCount() << std::endl;
+    std::cout << "Expected count: 20000" << std::endl;
+    std::cout << "Actual count: " << counter.getCount() << std::endl;
+}
+
+// Demo 2: incrementAndGet() hands out unique values even while
+// other threads hammer the fast path
+void demo2_exact_slow_path() {
+    std::cout << "\n=== DEMO 2: Exact incrementAndGet() Slow Path ===" << std::endl;
+
+    ShardedCounter counter;
+    std::vector<long> ticketsA, ticketsB;
+
+    auto ticketTask = [&counter](std::vector<long>& out) {
+        for (int i = 0; i < 1000; ++i) {
+            out.push_back(counter.incrementAndGet());
+        }
+    };
+    auto noiseTask = [&counter]() {
+        for (int i = 0; i < 100000; ++i) {
+            counter.increment();
+        }
+    };
+
+    std::thread t1(ticketTask, std::ref(ticketsA));
+    std::thread t2(ticketTask, std::ref(ticketsB));
+    std::thread t3(noiseTask);
+
+    t1.join();
+    t2.join();
+    t3.join();
+
+    // Merge both ticket lists and check for duplicates
+    std::vector<long> all(ticketsA);
+    all.insert(all.end(), ticketsB.begin(), ticketsB.end());
+    std::sort(all.begin(), all.end());
+    bool unique = std::adjacent_find(all.begin(), all.end()) == all.end();
+
+    std::cout << "Tickets handed out: " << all.size() << std::endl;
+    std::cout << "All tickets unique: " << (unique ? "yes" : "NO!") << std::endl;
+    std::cout << "Final count (expected 102000): " << counter.getCount() << std::endl;
+}
+
+// Demo 3: Throughput comparison at 1..hardware_concurrency threads
+void demo3_benchmark() {
+    std::cout << "\n=== DEMO 3: Benchmark (millions of increments/sec) ===" << std::endl;
+
+    const long opsPerThread = 200000;
+    unsigned maxThreads = std::max(2u, std::thread::hardware_concurrency());
+
+    std::cout << "threads\tmutex\tatomic\tsharded" << std::endl;
+    for (unsigned n = 1; n <= maxThreads; n *= 2) {
+        SafeCounter mutexCounter;
+        AtomicCounter atomicCounter;
+        ShardedCounter shardedCounter;
+
+        double m = measureIncrements(mutexCounter, n, opsPerThread);
+        double a = measureIncrements(atomicCounter, n, opsPerThread);
+        double s = measureIncrements(shardedCounter, n, opsPerThread);
+
+        std::cout << n << "\t" << m << "\t" << a << "\t" << s << std::endl;
+
+        // Sanity check: every counter must see every increment
+        long expected = static_cast<long>(n) * opsPerThread;
+        if (mutexCounter.getCount() != expected ||
+            atomicCounter.getCount() != expected ||
+            shardedCounter.getCount() != expected) {
+            std::cout << "ERROR: lost increments!" << std::endl;
+        }
+    }
+    std::cout << "Note: sharded throughput grows with cores; mutex and atomic do not" << std::endl;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== SHARDED COUNTER DEMONSTRATIONS ===" << std::endl;
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+
+    demo1_sharded_counter();
+    demo2_exact_slow_path();
+    demo3_benchmark();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// WHEN TO USE A SHARDED COUNTER
+// ============================================================================
+/*
+GOOD FIT:
+- Request counters, byte counters, hit/miss statistics
+- Many writers, few readers
+
+BAD FIT:
+- You need the exact value after EVERY increment (use SafeCounter or
+  a single atomic - or incrementAndGet() if it is rare)
+- Memory is tight: each shard costs a full cache line (64 bytes)
+
+PITFALL: FALSE SHARING
+- Two variables written by different threads on the SAME cache line
+  behave as if they were one shared variable
+- alignas(CACHE_LINE_SIZE) gives every slot its own line
+*/
@@ -0,0 +1,415 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+
+// ============================================================================
+// LESSON: LOCK-FREE TREIBER STACK
+// ============================================================================
+/*
+THE PROBLEM WITH SafeStack (demo_005.cpp):
+- push() and tryPop() both lock one std::mutex
+- Once several threads contend, waiting threads are put to sleep by the
+  kernel and woken up again -> system calls on every contended operation
+
+TREIBER STACK (R. K. Treiber, 1986):
+- The stack is a linked list; "head" points to the top node
+- push: new->next = head; CAS(head: old -> new)
+- pop:  old = head;       CAS(head: old -> old->next)
+- CAS (compare-and-swap) = compare_exchange_weak(): "if head still equals
+  what I read, replace it; otherwise tell me the new value and I retry"
+- No thread ever blocks: if a CAS fails, SOME other thread made progress
+
+THE ABA PROBLEM:
+- Thread A reads head = X, next = Y, then gets preempted
+- Thread B pops X, pops Y, pushes X back (same address!)
+- Thread A wakes up: head is X again, CAS succeeds, head = Y
+- But Y was already popped -> the stack is corrupted
+
+THE FIX USED HERE: TAGGED POINTERS
+- head stores (tag, node index) in ONE 64-bit word
+- Every successful CAS increments the tag
+- In the scenario above head went X(tag 1) -> ... -> X(tag 4),
+  so thread A's CAS against X(tag 1) fails
+
+MEMORY RECLAMATION:
+- A popped node is never returned to the allocator; it goes to an internal
+  FREELIST (itself a tagged Treiber stack) and is reused by the next push
+- Node memory stays valid for the lifetime of the stack, so a thread that
+  read a stale head can always safely read node->next (the tag check then
+  rejects the stale value)
+- The allocator is only called when the freelist is empty (rare slow path)
+*/
+
+// ============================================================================
+// BASELINE: Mutex Stack (same design as SafeStack in demo_005.cpp)
+// ============================================================================
+class SafeStack {
+private:
+    mutable std::mutex mtx;
+    std::vector<int> data;
+
+public:
+    void push(int value) {
+        std::lock_guard<std::mutex> lock(mtx);
+        data.push_back(value);
+    }
+
+    bool tryPop(int& result) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (data.empty()) {
+            return false;
+        }
+        result = data.back();
+        data.pop_back();
+        return true;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return data.size();
+    }
+
+    bool isEmpty() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return data.empty();
+    }
+};
+
+// ============================================================================
+// GOOD EXAMPLE: Lock-Free Stack with Tagged Indices and a Node Freelist
+// ============================================================================
+class LockFreeStack {
+private:
+    // Nodes are addressed by a 32-bit INDEX instead of a pointer, so that
+    // (tag, index) fits into a single 64-bit atomic on every platform
+    static constexpr uint32_t NIL = 0xFFFFFFFFu;
+    static constexpr uint32_t CHUNK_BITS = 10;
+    static constexpr uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;   // nodes per chunk
+    static constexpr uint32_t MAX_CHUNKS = 4096;               // up to 4M nodes
+
+    struct Node {
+        // Both fields are atomic because a thread holding a STALE head may
+        // read them while the node is being reused (the tag check makes the
+        // stale value harmless, but the read itself must not be a data race)
+        std::atomic<int> value{0};
+        std::atomic<uint32_t> next{NIL};
+    };
+
+    // Pack / unpack the (tag, index) pair
+    static uint64_t pack(uint32_t tag, uint32_t index) {
+        return (static_cast<uint64_t>(tag) << 32) | index;
+    }
+    static uint32_t tagOf(uint64_t word) { return static_cast<uint32_t>(word >> 32); }
+    static uint32_t indexOf(uint64_t word) { return static_cast<uint32_t>(word); }
+
+    // Node storage: a fixed table of chunk pointers, filled on demand
+    // Chunks are only freed in the destructor (type-stable memory)
+    std::atomic<Node*> chunks[MAX_CHUNKS];
+    uint32_t chunkCount;      // protected by growMtx
+    std::mutex growMtx;       // slow path only: allocating a new chunk
+
+    // The two tagged stacks: the data stack and the freelist
+    std::atomic<uint64_t> head;
+    std::atomic<uint64_t> freeHead;
+
+    // Approximate element count (exact when no operation is in flight)
+    std::atomic<long> count;
+
+    Node& node(uint32_t index) {
+        Node* chunk = chunks[index >> CHUNK_BITS].load(std::memory_order_acquire);
+        return chunk[index & (CHUNK_SIZE - 1)];
+    }
+
+    // Generic tagged-stack push: link 'index' on top of 'top'
+    void pushIndex(std::atomic<uint64_t>& top, uint32_t index) {
+        Node& n = node(index);
+        uint64_t old = top.load(std::memory_order_relaxed);
+        uint64_t desired;
+        do {
+            n.next.store(indexOf(old), std::memory_order_relaxed);
+            desired = pack(tagOf(old) + 1, index);
+        } while (!top.compare_exchange_weak(old, desired,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed));
+    }
+
+    // Generic tagged-stack pop: returns NIL if empty
+    uint32_t popIndex(std::atomic<uint64_t>& top) {
+        uint64_t old = top.load(std::memory_order_acquire);
+        for (;;) {
+            uint32_t index = indexOf(old);
+            if (index == NIL) {
+                return NIL;
+            }
+            // May read a stale 'next' if the node was popped and reused in the
+            // meantime - harmless because the tag in 'old' is then outdated
+            uint32_t next = node(index).next.load(std::memory_order_relaxed);
+            if (top.compare_exchange_weak(old, pack(tagOf(old) + 1, next),
+                                          std::memory_order_acquire,
+                                          std::memory_order_acquire)) {
+                return index;
+            }
+        }
+    }
+
+    // SLOW PATH: the freelist is empty -> allocate a whole chunk of nodes
+    uint32_t growAndAllocate() {
+        std::lock_guard<std::mutex> lock(growMtx);
+
+        // Another thread may have refilled the freelist while we waited
+        uint32_t index = popIndex(freeHead);
+        if (index != NIL) {
+            return index;
+        }
+        if (chunkCount == MAX_CHUNKS) {
+            throw std::runtime_error("LockFreeStack capacity exceeded");
+        }
+
+        uint32_t base = chunkCount << CHUNK_BITS;
+        chunks[chunkCount].store(new Node[CHUNK_SIZE], std::memory_order_release);
+        ++chunkCount;
+
+        // Keep the first node for the caller, give the rest to the freelist
+        for (uint32_t i = 1; i < CHUNK_SIZE; ++i) {
+            pushIndex(freeHead, base + i);
+        }
+        return base;
+    }
+
+    // FAST PATH: reuse a node from the freelist (no allocator call)
+    uint32_t allocateNode() {
+        uint32_t index = popIndex(freeHead);
+        return index != NIL ? index : growAndAllocate();
+    }
+
+public:
+    LockFreeStack()
+        : chunkCount(0), head(pack(0, NIL)), freeHead(pack(0, NIL)), count(0) {
+        for (auto& c : chunks) {
+            c.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~LockFreeStack() {
+        for (uint32_t i = 0; i < chunkCount; ++i) {
+            delete[] chunks[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    // Like SafeLogger: a synchronization object must not be copied
+    LockFreeStack(const LockFreeStack&) = delete;
+    LockFreeStack& operator=(const LockFreeStack&) = delete;
+
+    // Same interface as SafeStack
+    void push(int value) {
+        uint32_t index = allocateNode();
+        node(index).value.store(value, std::memory_order_relaxed);
+        pushIndex(head, index);   // release: publishes 'value'
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool tryPop(int& result) {
+        uint32_t index = popIndex(head);   // acquire: sees 'value'
+        if (index == NIL) {
+            return false;
+        }
+        result = node(index).value.load(std::memory_order_relaxed);
+        pushIndex(freeHead, index);        // recycle the node
+        count.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Snapshot values: may be stale as soon as they are returned
+    // (true for SafeStack as well - another thread can push right after)
+    size_t size() const {
+        long n = count.load(std::memory_order_relaxed);
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+
+    bool isEmpty() const {
+        return indexOf(head.load(std::memory_order_acquire)) == NIL;
+    }
+};
+
+// ============================================================================
+// BENCHMARK HELPER
+// ============================================================================
+// 'pairs' producers each push itemsPerProducer values while 'pairs' consumers
+// pop until everything has been consumed. Returns millions of push+pop per sec
+template <typename Stack>
+double measureStack(unsigned pairs, int itemsPerProducer, long long& checksum) {
+    Stack stack;
+    std::atomic<bool> go{false};
+    std::atomic<long> remaining{static_cast<long>(pairs) * itemsPerProducer};
+    std::atomic<long long> sum{0};
+    std::vector<std::thread> threads;
+
+    for (unsigned p = 0; p < pairs; ++p) {
+        threads.emplace_back([&stack, &go, itemsPerProducer]() {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (int i = 0; i < itemsPerProducer; ++i) {
+                stack.push(i);
+            }
+        });
+        threads.emplace_back([&stack, &go, &remaining, &sum]() {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            long long localSum = 0;
+            int value;
+            while (remaining.load(std::memory_order_relaxed) > 0) {
+                if (stack.tryPop(value)) {
+                    localSum += value;
+                    remaining.fetch_sub(1, std::memory_order_relaxed);
+                } else {
+                    std::this_thread::yield();   // empty: let producers run
+                }
+            }
+            sum.fetch_add(localSum);
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) t.join();
+    auto end = std::chrono::steady_clock::now();
+
+    checksum = sum.load();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return 2.0 * pairs * itemsPerProducer / seconds / 1e6;
+}
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: Same producer/consumer pattern as demo4_safe_stack
+void demo1_lock_free_stack() {
+    std::cout << "\n=== DEMO 1: Lock-Free Stack (Drop-in for SafeStack) ===" << std::endl;
+
+    LockFreeStack stack;
+    int popped = 0;
+
+    auto producer = [&stack]() {
+        for (int i = 0; i < 100; ++i) {
+            stack.push(i);
+        }
+    };
+
+    auto consumer = [&stack, &popped]() {
+        int value;
+        // Keep popping until all 100 items were seen
+        while (popped < 100) {
+            if (stack.tryPop(value)) {
+                ++popped;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    };
+
+    std::thread t1(producer);
+    std::thread t2(consumer);
+
+    t1.join();
+    t2.join();
+
+    std::cout << "Items popped: " << popped << std::endl;
+    std::cout << "Remaining items in stack: " << stack.size() << std::endl;
+    std::cout << "Stack empty: " << (stack.isEmpty() ? "yes" : "no") << std::endl;
+}
+
+// Demo 2: Many threads push and pop the same values - nothing may be lost
+// or duplicated (this is where an ABA bug would show up)
+void demo2_aba_stress() {
+    std::cout << "\n=== DEMO 2: ABA Stress Test ===" << std::endl;
+
+    LockFreeStack stack;
+    const int threadsCount = 4;
+    const int rounds = 50000;
+
+    // Every thread repeatedly pushes its id and pops something back
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadsCount; ++t) {
+        threads.emplace_back([&stack, t]() {
+            int value;
+            for (int i = 0; i < rounds; ++i) {
+                stack.push(t);
+                while (!stack.tryPop(value)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    std::cout << "Operations: " << 2 * threadsCount * rounds << std::endl;
+    std::cout << "Stack empty afterwards (expected yes): "
+              << (stack.isEmpty() ? "yes" : "NO!") << std::endl;
+}
+
+// Demo 3: Throughput at 1..N producers and N consumers
+void demo3_benchmark() {
+    std::cout << "\n=== DEMO 3: Benchmark (millions of push+pop/sec) ===" << std::endl;
+
+    const int itemsPerProducer = 100000;
+    unsigned maxPairs = std::max(2u, std::thread::hardware_concurrency());
+    long long expected = static_cast<long long>(itemsPerProducer - 1) * itemsPerProducer / 2;
+
+    std::cout << "producers\tconsumers\tSafeStack\tLockFreeStack" << std::endl;
+    for (unsigned n = 1; n <= maxPairs; n *= 2) {
+        long long sumMutex = 0, sumLockFree = 0;
+        double m = measureStack<SafeStack>(n, itemsPerProducer, sumMutex);
+        double l = measureStack<LockFreeStack>(n, itemsPerProducer, sumLockFree);
+        std::cout << n << "\t\t" << n << "\t\t" << m << "\t\t" << l << std::endl;
+
+        if (sumMutex != expected * n || sumLockFree != expected * n) {
+            std::cout << "ERROR: lost or duplicated items!" << std::endl;
+        }
+    }
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== LOCK-FREE STACK DEMONSTRATIONS ===" << std::endl;
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+
+    demo1_lock_free_stack();
+    demo2_aba_stress();
+    demo3_benchmark();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// LIMITATIONS
+// ============================================================================
+/*
+1. TAG WRAP-AROUND
+   - The tag is 32 bits; ABA is only possible if exactly 2^32 successful
+     operations happen while one thread is preempted between reading head
+     and its CAS - practically impossible
+
+2. MEMORY IS NEVER SHRUNK
+   - Nodes go back to the freelist, not to the allocator
+   - Peak size determines memory usage until the stack is destroyed
+
+3. LOCK-FREE IS NOT "FASTER" BY DEFAULT
+   - head is still ONE hot cache line; under heavy contention CAS retries
+     replace mutex waiting
+   - The gain is that no thread ever sleeps in the kernel and a preempted
+     thread cannot block the others
+
+ALTERNATIVES FOR RECLAMATION:
+- Hazard pointers: threads announce which node they are reading
+- Epoch-based reclamation: free nodes once every thread passed a checkpoint
+- Both allow returning memory to the allocator, at the cost of more code
+*/
@@ -0,0 +1,437 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <chrono>
+#include <algorithm>
+
+// ============================================================================
+// LESSON: ELIMINATION BACKOFF STACK
+// ============================================================================
+/*
+THE PROBLEM:
+- In demo4_safe_stack producers push and consumers pop the SAME top
+- Whether protected by a mutex (demo_005) or a CAS (demo_009), the top of
+  the stack is ONE hot spot: more threads = more waiting / more retries
+
+KEY OBSERVATION (Hendler, Shavit, Yerushalmi 2004):
+- A push(x) immediately followed by a pop() leaves the stack unchanged
+  and the pop returns x
+- So if a push and a pop run AT THE SAME TIME, they can simply hand x
+  over to each other and never touch the stack at all ("elimination")
+
+HOW IT WORKS:
+- In front of the stack sits an ELIMINATION ARRAY of exchange slots
+- A thread first tries the stack lock with try_lock()
+- If the lock is busy (= contention), the thread visits a random slot:
+    * slot empty      -> leave an offer and wait a moment for a partner
+    * opposite offer  -> take it: the operation is done
+- Only if no partner shows up does the thread go back to the stack
+
+ADAPTIVE SIZING:
+- Too FEW slots: threads collide on busy slots -> grow the array
+- Too MANY slots: offers time out because partners pick other slots
+  -> shrink the array
+- The active width therefore follows the observed contention
+*/
+
+// ============================================================================
+// BASELINE: Mutex Stack (same design as SafeStack in demo_005.cpp)
+// ============================================================================
+class SafeStack {
+private:
+    mutable std::mutex mtx;
+    std::vector<int> data;
+
+public:
+    void push(int value) {
+        std::lock_guard<std::mutex> lock(mtx);
+        data.push_back(value);
+    }
+
+    bool tryPop(int& result) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (data.empty()) {
+            return false;
+        }
+        result = data.back();
+        data.pop_back();
+        return true;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return data.size();
+    }
+
+    bool isEmpty() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return data.empty();
+    }
+};
+
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+// ============================================================================
+// ELIMINATION ARRAY
+// ============================================================================
+class EliminationArray {
+private:
+    // Each slot is ONE 64-bit word: [state:2][tag:30][value:32]
+    // - state: what the slot currently holds
+    // - tag:   incremented for every new offer, so an old offer can never be
+    //          confused with a new one carrying the same value (ABA)
+    // - value: the element being handed over
+    enum State : uint64_t {
+        EMPTY        = 0,  // free
+        PUSH_WAITING = 1,  // a push is waiting, value = element
+        POP_WAITING  = 2,  // a pop is waiting for an element
+        DONE         = 3   // partner matched the offer (value = element for pops)
+    };
+
+    static uint64_t make(uint64_t state, uint64_t tag, uint32_t value) {
+        return (state << 62) | ((tag & 0x3FFFFFFFu) << 32) | value;
+    }
+    static uint64_t stateOf(uint64_t w) { return w >> 62; }
+    static uint64_t tagOf(uint64_t w) { return (w >> 32) & 0x3FFFFFFFu; }
+    static int valueOf(uint64_t w) { return static_cast<int>(static_cast<uint32_t>(w)); }
+
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        std::atomic<uint64_t> word{0};
+    };
+
+    static constexpr unsigned MAX_WIDTH = 16;
+    static constexpr int SPIN_LIMIT = 128;   // how long an offer waits
+
+    Slot slots[MAX_WIDTH];
+    std::atomic<unsigned> width{1};          // active part of the array
+
+    // Cheap per-thread random number (xorshift)
+    static unsigned randomIndex(unsigned bound) {
+        thread_local uint32_t seed =
+            static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1u;
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed % bound;
+    }
+
+    // Contention feedback: slot busy -> more slots; no partner -> fewer slots
+    void grow() {
+        unsigned w = width.load(std::memory_order_relaxed);
+        if (w < MAX_WIDTH) width.compare_exchange_weak(w, w + 1, std::memory_order_relaxed);
+    }
+    void shrink() {
+        unsigned w = width.load(std::memory_order_relaxed);
+        if (w > 1) width.compare_exchange_weak(w, w - 1, std::memory_order_relaxed);
+    }
+
+    // Wait for a partner to turn our offer into DONE
+    // Returns the DONE word, or 0 if the offer was withdrawn (timeout)
+    uint64_t awaitPartner(std::atomic<uint64_t>& word, uint64_t offer) {
+        for (int i = 0; i < SPIN_LIMIT; ++i) {
+            uint64_t cur = word.load(std::memory_order_acquire);
+            if (cur != offer) {
+                return cur;  // only a partner can change our offer (to DONE)
+            }
+        }
+        // Timeout: withdraw the offer - if the CAS fails, a partner got it
+        uint64_t expected = offer;
+        if (word.compare_exchange_strong(expected, make(EMPTY, tagOf(offer), 0),
+                                         std::memory_order_acq_rel)) {
+            return 0;
+        }
+        return expected;
+    }
+
+public:
+    // Try to hand 'value' directly to a concurrent pop
+    bool tryEliminatePush(int value) {
+        std::atomic<uint64_t>& word =
+            slots[randomIndex(width.load(std::memory_order_relaxed))].word;
+        uint64_t cur = word.load(std::memory_order_acquire);
+
+        switch (stateOf(cur)) {
+        case POP_WAITING: {
+            // A pop is waiting: deliver the value, the pop resets the slot
+            uint64_t done = make(DONE, tagOf(cur), static_cast<uint32_t>(value));
+            if (word.compare_exchange_strong(cur, done, std::memory_order_acq_rel)) {
+                return true;
+            }
+            grow();
+            return false;
+        }
+        case EMPTY: {
+            // Leave an offer and wait for a pop to take it
+            uint64_t offer = make(PUSH_WAITING, tagOf(cur) + 1, static_cast<uint32_t>(value));
+            if (!word.compare_exchange_strong(cur, offer, std::memory_order_acq_rel)) {
+                grow();
+                return false;
+            }
+            uint64_t done = awaitPartner(word, offer);
+            if (done == 0) {
+                shrink();
+                return false;
+            }
+            word.store(make(EMPTY, tagOf(offer), 0), std::memory_order_release);
+            return true;
+        }
+        default:
+            grow();   // another push waiting or a handover in progress
+            return false;
+        }
+    }
+
+    // Try to take a value directly from a concurrent push
+    bool tryEliminatePop(int& result) {
+        std::atomic<uint64_t>& word =
+            slots[randomIndex(width.load(std::memory_order_relaxed))].word;
+        uint64_t cur = word.load(std::memory_order_acquire);
+
+        switch (stateOf(cur)) {
+        case PUSH_WAITING: {
+            // A push is waiting: take its value, the push resets the slot
+            if (word.compare_exchange_strong(cur, make(DONE, tagOf(cur), 0),
+                                             std::memory_order_acq_rel)) {
+                result = valueOf(cur);
+                return true;
+            }
+            grow();
+            return false;
+        }
+        case EMPTY: {
+            // Leave a request and wait for a push to fill it
+            uint64_t offer = make(POP_WAITING, tagOf(cur) + 1, 0);
+            if (!word.compare_exchange_strong(cur, offer, std::memory_order_acq_rel)) {
+                grow();
+                return false;
+            }
+            uint64_t done = awaitPartner(word, offer);
+            if (done == 0) {
+                shrink();
+                return false;
+            }
+            result = valueOf(done);
+            word.store(make(EMPTY, tagOf(offer), 0), std::memory_order_release);
+            return true;
+        }
+        default:
+            grow();
+            return false;
+        }
+    }
+
+    unsigned currentWidth() const { return width.load(std::memory_order_relaxed); }
+};
+
+// ============================================================================
+// GOOD EXAMPLE: SafeStack with an Elimination Layer
+// ============================================================================
+class EliminationStack {
+private:
+    mutable std::mutex mtx;
+    std::vector<int> data;
+    EliminationArray elimination;
+    std::atomic<long> eliminated{0};   // statistics only
+
+public:
+    // Same interface as SafeStack
+    void push(int value) {
+        // 1. Uncontended: just use the stack
+        if (mtx.try_lock()) {
+            std::lock_guard<std::mutex> lock(mtx, std::adopt_lock);
+            data.push_back(value);
+            return;
+        }
+        // 2. Contended: try to meet a pop in the elimination array
+        if (elimination.tryEliminatePush(value)) {
+            return;   // counted once, by the matching tryPop
+        }
+        // 3. No partner: wait for the stack like SafeStack does
+        std::lock_guard<std::mutex> lock(mtx);
+        data.push_back(value);
+    }
+
+    bool tryPop(int& result) {
+        if (mtx.try_lock()) {
+            std::lock_guard<std::mutex> lock(mtx, std::adopt_lock);
+            if (data.empty()) {
+                return false;
+            }
+            result = data.back();
+            data.pop_back();
+            return true;
+        }
+        if (elimination.tryEliminatePop(result)) {
+            eliminated.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        if (data.empty()) {
+            return false;
+        }
+        result = data.back();
+        data.pop_back();
+        return true;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return data.size();
+    }
+
+    bool isEmpty() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return data.empty();
+    }
+
+    // Number of push/pop pairs that never touched the stack
+    long eliminatedCount() const { return eliminated.load(std::memory_order_relaxed); }
+    unsigned eliminationWidth() const { return elimination.currentWidth(); }
+};
+
+// ============================================================================
+// BENCHMARK HELPER
+// ============================================================================
+// Balanced workload: every thread alternates push and tryPop
+// Returns millions of operations per second
+template <typename Stack>
+double measureBalanced(Stack& stack, unsigned numThreads, int roundsPerThread,
+                       long long& checksum) {
+    std::atomic<bool> go{false};
+    std::atomic<long long> popped{0};
+    std::vector<std::thread> threads;
+
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&stack, &go, &popped, roundsPerThread]() {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            long long localSum = 0;
+            int value;
+            for (int i = 0; i < roundsPerThread; ++i) {
+                stack.push(i);
+                if (stack.tryPop(value)) {
+                    localSum += value;
+                }
+            }
+            popped.fetch_add(localSum);
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) t.join();
+    auto end = std::chrono::steady_clock::now();
+
+    // Drain what is left so the checksum covers every pushed value
+    long long rest = 0;
+    int value;
+    while (stack.tryPop(value)) rest += value;
+    checksum = popped.load() + rest;
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return 2.0 * numThreads * roundsPerThread / seconds / 1e6;
+}
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: The producer/consumer pattern from demo4_safe_stack
+void demo1_elimination_stack() {
+    std::cout << "\n=== DEMO 1: Elimination Stack (Producer/Consumer) ===" << std::endl;
+
+    EliminationStack stack;
+    std::atomic<int> consumed{0};
+
+    auto producer = [&stack]() {
+        for (int i = 0; i < 10000; ++i) {
+            stack.push(i);
+        }
+    };
+
+    auto consumer = [&stack, &consumed]() {
+        int value;
+        while (consumed.load() < 20000) {
+            if (stack.tryPop(value)) {
+                consumed.fetch_add(1);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    };
+
+    std::thread p1(producer), p2(producer);
+    std::thread c1(consumer), c2(consumer);
+
+    p1.join();
+    p2.join();
+    c1.join();
+    c2.join();
+
+    std::cout << "Items consumed: " << consumed.load() << " (expected 20000)" << std::endl;
+    std::cout << "Remaining items in stack: " << stack.size() << std::endl;
+    std::cout << "Eliminated push/pop pairs: " << stack.eliminatedCount() << std::endl;
+    std::cout << "Elimination array width: " << stack.eliminationWidth() << std::endl;
+}
+
+// Demo 2: Balanced push/pop throughput at growing thread counts
+void demo2_benchmark() {
+    std::cout << "\n=== DEMO 2: Benchmark (millions of ops/sec, balanced) ===" << std::endl;
+
+    const int rounds = 100000;
+    unsigned maxThreads = std::max(4u, std::thread::hardware_concurrency());
+    long long expectedPerThread = static_cast<long long>(rounds - 1) * rounds / 2;
+
+    std::cout << "threads\tSafeStack\tEliminationStack\teliminated\twidth" << std::endl;
+    for (unsigned n = 1; n <= maxThreads; n *= 2) {
+        SafeStack plain;
+        EliminationStack elim;
+        long long sumPlain = 0, sumElim = 0;
+
+        double p = measureBalanced(plain, n, rounds, sumPlain);
+        double e = measureBalanced(elim, n, rounds, sumElim);
+
+        std::cout << n << "\t" << p << "\t\t" << e << "\t\t\t"
+                  << elim.eliminatedCount() << "\t\t" << elim.eliminationWidth() << std::endl;
+
+        if (sumPlain != expectedPerThread * n || sumElim != expectedPerThread * n) {
+            std::cout << "ERROR: lost or duplicated items!" << std::endl;
+        }
+    }
+    std::cout << "Note: elimination only kicks in when try_lock() fails," << std::endl;
+    std::cout << "so with a single core the two columns stay close" << std::endl;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== ELIMINATION BACKOFF STACK DEMONSTRATIONS ===" << std::endl;
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+
+    demo1_elimination_stack();
+    demo2_benchmark();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// WHEN DOES ELIMINATION HELP?
+// ============================================================================
+/*
+HELPS:
+- Many threads, roughly as many pushes as pops at the same time
+- The more contention, the more collisions -> throughput GROWS with threads
+
+DOES NOT HELP:
+- Push-only or pop-only phases (nobody to pair with)
+- Low contention: try_lock() succeeds and the array is never visited
+
+ORDERING NOTE:
+- An eliminated pair behaves exactly like "push(x); pop() == x" happening
+  instantly, so the stack still behaves as a correct LIFO
+*/
@@ -0,0 +1,457 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+
+// ============================================================================
+// LESSON: BOUNDED MPMC RING-BUFFER QUEUE
+// ============================================================================
+/*
+THE PROBLEM:
+- demo4_safe_stack moves integers from a producer to a consumer through
+  SafeStack - a LIFO behind a mutex
+- Real pipelines want FIFO: items should leave in the order they arrived
+- And a growing std::vector means the allocator sits on the hot path
+
+THE SOLUTION: BOUNDED RING BUFFER (D. Vyukov's MPMC queue)
+- A fixed array of 'capacity' slots, capacity is a power of two
+- tail: next position to WRITE (producers), head: next position to READ
+- position -> slot: pos & (capacity - 1)  (cheap, because power of two)
+- Every slot carries a SEQUENCE NUMBER that says whose turn it is:
+    seq == pos       -> slot is free for the producer of position 'pos'
+    seq == pos + 1   -> slot holds the item for the consumer of 'pos'
+    after the consumer is done: seq = pos + capacity (free for next lap)
+
+WHY IT IS FAST:
+- A producer claims a position with ONE CAS on tail, a consumer with ONE
+  CAS on head - producers and consumers never touch the same counter
+- head and tail live on SEPARATE cache lines (padding)
+- No allocation after construction, no locks, no kernel calls
+- Bulk variants claim several positions with a single CAS
+*/
+
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+// ============================================================================
+// BASELINE: Mutex Stack (same design as SafeStack in demo_005.cpp)
+// ============================================================================
+class SafeStack {
+private:
+    mutable std::mutex mtx;
+    std::vector<int> data;
+
+public:
+    void push(int value) {
+        std::lock_guard<std::mutex> lock(mtx);
+        data.push_back(value);
+    }
+
+    bool tryPop(int& result) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (data.empty()) {
+            return false;
+        }
+        result = data.back();
+        data.pop_back();
+        return true;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return data.size();
+    }
+};
+
+// ============================================================================
+// GOOD EXAMPLE: Bounded Multi-Producer Multi-Consumer Queue
+// ============================================================================
+template <typename T>
+class MPMCQueue {
+private:
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    const std::size_t capacity;
+    const std::size_t mask;
+    std::unique_ptr<Slot[]> slots;
+
+    // Producers and consumers each get their own cache line
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail;   // producers
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head;   // consumers
+
+    static bool isPowerOfTwo(std::size_t n) { return n != 0 && (n & (n - 1)) == 0; }
+
+    // Distance between a slot's sequence and the position we want
+    static std::intptr_t diff(std::size_t seq, std::size_t pos) {
+        return static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+    }
+
+public:
+    explicit MPMCQueue(std::size_t capacity_)
+        : capacity(capacity_), mask(capacity_ - 1), slots(nullptr), tail(0), head(0) {
+        if (!isPowerOfTwo(capacity)) {
+            throw std::runtime_error("MPMCQueue capacity must be a power of two");
+        }
+        slots.reset(new Slot[capacity]);
+        for (std::size_t i = 0; i < capacity; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Like SafeLogger: a synchronization object must not be copied
+    MPMCQueue(const MPMCQueue&) = delete;
+    MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+    // Returns false if the queue is full
+    bool tryPush(const T& item) {
+        std::size_t pos = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[pos & mask];
+            std::size_t seq = slot.sequence.load(std::memory_order_acquire);
+            std::intptr_t d = diff(seq, pos);
+            if (d == 0) {
+                // Slot is free for this position: try to claim it
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = item;
+                    slot.sequence.store(pos + 1, std::memory_order_release);  // publish
+                    return true;
+                }
+                // CAS failed: pos now holds the current tail, retry
+            } else if (d < 0) {
+                return false;   // slot still holds an item from the previous lap: full
+            } else {
+                pos = tail.load(std::memory_order_relaxed);  // another producer was faster
+            }
+        }
+    }
+
+    // Returns false if the queue is empty
+    bool tryPop(T& result) {
+        std::size_t pos = head.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[pos & mask];
+            std::size_t seq = slot.sequence.load(std::memory_order_acquire);
+            std::intptr_t d = diff(seq, pos + 1);
+            if (d == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    result = std::move(slot.value);
+                    // Free the slot for the producer one lap ahead
+                    slot.sequence.store(pos + capacity, std::memory_order_release);
+                    return true;
+                }
+            } else if (d < 0) {
+                return false;   // producer has not published this position yet: empty
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Push up to 'count' items with ONE claim on tail
+    // Returns how many items were pushed (0 if the queue is full)
+    std::size_t tryPushBulk(const T* items, std::size_t count) {
+        std::size_t pos = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            // Count how many consecutive slots are free starting at pos
+            // A free slot stays free until someone moves tail past it,
+            // so the count is still valid if the CAS below succeeds
+            std::size_t ready = 0;
+            while (ready < count) {
+                std::size_t seq = slots[(pos + ready) & mask].sequence.load(std::memory_order_acquire);
+                if (diff(seq, pos + ready) != 0) break;
+                ++ready;
+            }
+            if (ready == 0) {
+                std::size_t seq = slots[pos & mask].sequence.load(std::memory_order_acquire);
+                if (diff(seq, pos) < 0) return 0;          // full
+                pos = tail.load(std::memory_order_relaxed);  // stale pos, retry
+                continue;
+            }
+            if (tail.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed)) {
+                for (std::size_t i = 0; i < ready; ++i) {
+                    Slot& slot = slots[(pos + i) & mask];
+                    slot.value = items[i];
+                    slot.sequence.store(pos + i + 1, std::memory_order_release);
+                }
+                return ready;
+            }
+        }
+    }
+
+    // Pop up to 'maxCount' items with ONE claim on head
+    // Returns how many items were written to 'out' (0 if the queue is empty)
+    std::size_t tryPopBulk(T* out, std::size_t maxCount) {
+        std::size_t pos = head.load(std::memory_order_relaxed);
+        for (;;) {
+            std::size_t ready = 0;
+            while (ready < maxCount) {
+                std::size_t seq = slots[(pos + ready) & mask].sequence.load(std::memory_order_acquire);
+                if (diff(seq, pos + ready + 1) != 0) break;
+                ++ready;
+            }
+            if (ready == 0) {
+                std::size_t seq = slots[pos & mask].sequence.load(std::memory_order_acquire);
+                if (diff(seq, pos + 1) < 0) return 0;      // empty
+                pos = head.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (head.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed)) {
+                for (std::size_t i = 0; i < ready; ++i) {
+                    Slot& slot = slots[(pos + i) & mask];
+                    out[i] = std::move(slot.value);
+                    slot.sequence.store(pos + i + capacity, std::memory_order_release);
+                }
+                return ready;
+            }
+        }
+    }
+
+    // Approximate: exact only when no operation is in flight
+    std::size_t size() const {
+        std::size_t t = tail.load(std::memory_order_acquire);
+        std::size_t h = head.load(std::memory_order_acquire);
+        return t >= h ? t - h : 0;
+    }
+
+    std::size_t getCapacity() const { return capacity; }
+};
+
+// ============================================================================
+// BENCHMARK HELPERS
+// ============================================================================
+// Adapters so one benchmark loop can drive both containers
+struct StackAdapter {
+    SafeStack stack;
+    bool push(int v) { stack.push(v); return true; }
+    bool pop(int& v) { return stack.tryPop(v); }
+};
+
+struct QueueAdapter {
+    MPMCQueue<int> queue{1024};
+    bool push(int v) { return queue.tryPush(v); }
+    bool pop(int& v) { return queue.tryPop(v); }
+};
+
+// 'pairs' producers and 'pairs' consumers move itemsPerProducer items each
+// Returns millions of items per second
+template <typename Container>
+double measureTransfer(unsigned pairs, int itemsPerProducer, long long& checksum) {
+    Container c;
+    std::atomic<bool> go{false};
+    std::atomic<long> remaining{static_cast<long>(pairs) * itemsPerProducer};
+    std::atomic<long long> sum{0};
+    std::vector<std::thread> threads;
+
+    for (unsigned p = 0; p < pairs; ++p) {
+        threads.emplace_back([&c, &go, itemsPerProducer]() {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (int i = 0; i < itemsPerProducer; ++i) {
+                while (!c.push(i)) std::this_thread::yield();   // full: back off
+            }
+        });
+        threads.emplace_back([&c, &go, &remaining, &sum]() {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            long long localSum = 0;
+            int value;
+            while (remaining.load(std::memory_order_relaxed) > 0) {
+                if (c.pop(value)) {
+                    localSum += value;
+                    remaining.fetch_sub(1, std::memory_order_relaxed);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+            sum.fetch_add(localSum);
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) t.join();
+    auto end = std::chrono::steady_clock::now();
+
+    checksum = sum.load();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return static_cast<double>(pairs) * itemsPerProducer / seconds / 1e6;
+}
+
+// Same transfer, but producers and consumers move batches of 64 items
+double measureBulkTransfer(unsigned pairs, int itemsPerProducer, long long& checksum) {
+    const std::size_t BATCH = 64;
+    MPMCQueue<int> queue(1024);
+    std::atomic<bool> go{false};
+    std::atomic<long> remaining{static_cast<long>(pairs) * itemsPerProducer};
+    std::atomic<long long> sum{0};
+    std::vector<std::thread> threads;
+
+    for (unsigned p = 0; p < pairs; ++p) {
+        threads.emplace_back([&queue, &go, itemsPerProducer, BATCH]() {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            int batch[BATCH];
+            int next = 0;
+            while (next < itemsPerProducer) {
+                std::size_t n = std::min<std::size_t>(BATCH, itemsPerProducer - next);
+                for (std::size_t i = 0; i < n; ++i) batch[i] = next + static_cast<int>(i);
+                std::size_t done = 0;
+                while (done < n) {
+                    std::size_t pushed = queue.tryPushBulk(batch + done, n - done);
+                    if (pushed == 0) std::this_thread::yield();
+                    done += pushed;
+                }
+                next += static_cast<int>(n);
+            }
+        });
+        threads.emplace_back([&queue, &go, &remaining, &sum, BATCH]() {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            int batch[BATCH];
+            long long localSum = 0;
+            while (remaining.load(std::memory_order_relaxed) > 0) {
+                std::size_t n = queue.tryPopBulk(batch, BATCH);
+                if (n == 0) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                for (std::size_t i = 0; i < n; ++i) localSum += batch[i];
+                remaining.fetch_sub(static_cast<long>(n), std::memory_order_relaxed);
+            }
+            sum.fetch_add(localSum);
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) t.join();
+    auto end = std::chrono::steady_clock::now();
+
+    checksum = sum.load();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return static_cast<double>(pairs) * itemsPerProducer / seconds / 1e6;
+}
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: demo4_safe_stack rewritten as a FIFO pipeline
+void demo1_fifo_pipeline() {
+    std::cout << "\n=== DEMO 1: FIFO Producer/Consumer with MPMCQueue ===" << std::endl;
+
+    MPMCQueue<int> queue(64);   // smaller than the item count: exercises "full"
+    bool inOrder = true;
+    int received = 0;
+
+    auto producer = [&queue]() {
+        for (int i = 0; i < 100; ++i) {
+            while (!queue.tryPush(i)) {
+                std::this_thread::yield();   // queue full: wait for consumer
+            }
+        }
+    };
+
+    auto consumer = [&queue, &inOrder, &received]() {
+        int value;
+        while (received < 100) {
+            if (queue.tryPop(value)) {
+                // One producer + one consumer: FIFO means values arrive in order
+                if (value != received) inOrder = false;
+                ++received;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    };
+
+    std::thread t1(producer);
+    std::thread t2(consumer);
+
+    t1.join();
+    t2.join();
+
+    std::cout << "Items received: " << received << std::endl;
+    std::cout << "Received in FIFO order: " << (inOrder ? "yes" : "NO!") << std::endl;
+    std::cout << "Remaining items in queue: " << queue.size() << std::endl;
+}
+
+// Demo 2: Bulk operations
+void demo2_bulk() {
+    std::cout << "\n=== DEMO 2: Bulk Push/Pop ===" << std::endl;
+
+    MPMCQueue<int> queue(8);
+    int items[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+    std::size_t pushed = queue.tryPushBulk(items, 10);
+    std::cout << "Tried to push 10 items into capacity 8, pushed: " << pushed << std::endl;
+
+    int out[10];
+    std::size_t popped = queue.tryPopBulk(out, 10);
+    std::cout << "Popped " << popped << " items:";
+    for (std::size_t i = 0; i < popped; ++i) std::cout << " " << out[i];
+    std::cout << std::endl;
+}
+
+// Demo 3: Throughput compared against SafeStack
+void demo3_benchmark() {
+    std::cout << "\n=== DEMO 3: Benchmark (millions of items/sec) ===" << std::endl;
+
+    const int itemsPerProducer = 200000;
+    unsigned maxPairs = std::max(2u, std::thread::hardware_concurrency());
+    long long expected = static_cast<long long>(itemsPerProducer - 1) * itemsPerProducer / 2;
+
+    std::cout << "producers\tconsumers\tSafeStack\tMPMCQueue\tMPMCQueue(bulk 64)" << std::endl;
+    for (unsigned n = 1; n <= maxPairs; n *= 2) {
+        long long s1 = 0, s2 = 0, s3 = 0;
+        double stack = measureTransfer<StackAdapter>(n, itemsPerProducer, s1);
+        double queue = measureTransfer<QueueAdapter>(n, itemsPerProducer, s2);
+        double bulk = measureBulkTransfer(n, itemsPerProducer, s3);
+        std::cout << n << "\t\t" << n << "\t\t" << stack << "\t\t" << queue
+                  << "\t\t" << bulk << std::endl;
+
+        if (s1 != expected * n || s2 != expected * n || s3 != expected * n) {
+            std::cout << "ERROR: lost or duplicated items!" << std::endl;
+        }
+    }
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== BOUNDED MPMC QUEUE DEMONSTRATIONS ===" << std::endl;
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+
+    demo1_fifo_pipeline();
+    demo2_bulk();
+    demo3_benchmark();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// DESIGN NOTES
+// ============================================================================
+/*
+BOUNDED ON PURPOSE:
+- A full queue returns false instead of growing
+- This is BACKPRESSURE: a fast producer is slowed down to the speed of
+  the consumers instead of filling all memory
+
+FIFO WITH MANY PRODUCERS:
+- Items from ONE producer leave in the order that producer pushed them
+- Items from DIFFERENT producers are ordered by who claimed a position first
+
+PER-SLOT PADDING:
+- Every slot is a full cache line, so neighbouring slots written by
+  different threads do not falsely share a line
+- Costs memory (64 bytes per slot) - fine for queues of a few thousand
+  entries, reconsider for millions
+*/
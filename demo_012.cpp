@@ -0,0 +1,478 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <memory>
+#include <sstream>
+#include <fstream>
+#include <chrono>
+#include <stdexcept>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+// ============================================================================
+// LESSON: ASYNCHRONOUS (BACKGROUND-WRITER) LOGGER
+// ============================================================================
+/*
+THE PROBLEM WITH SafeLogger::log (demo_005.cpp):
+    std::lock_guard<std::mutex> lock(mtx);
+    logFile << "[" << std::this_thread::get_id() << "] " << message << std::endl;
+- The mutex is held while FORMATTING and while WRITING to the file
+- std::endl flushes -> one write() system call per message
+- Every other thread waits for that system call to finish
+
+THE SOLUTION: PER-THREAD DOUBLE BUFFERS WITH A BACKGROUND WRITER
+- Each caller APPENDS the finished record to ITS OWN in-memory buffer
+  (a per-thread lock, held for a memcpy - callers never wait for each
+  other, only for the writer's O(1) swap)
+- One background thread swaps every full buffer with an empty one and
+  writes the batches with a few large write(2) calls
+- Callers never touch the file
+
+            callers                         background thread
+    thread A: log() -> A.front  ---------> swap(A.front, A.back), write(A.back)
+    thread B: log() -> B.front  ---------> swap(B.front, B.back), write(B.back)
+    thread C: log() -> C.front  ---------> swap(C.front, C.back), write(C.back)
+
+GUARANTEES:
+- Records of one thread stay in order; records of different threads are
+  grouped per batch instead of interleaved by arrival time
+- flush(): returns only after everything logged before the call is in the
+  file, and throws if a write(2) failed and records were lost
+- Destructor: flushes everything, stops the background thread and reports
+  lost records on std::cerr (destructors must not throw)
+- Backpressure: if the writer falls behind by MAX_PENDING bytes, callers
+  wait instead of using unbounded memory
+*/
+
+// ============================================================================
+// BASELINE: Synchronous Logger (same design as SafeLogger in demo_005.cpp)
+// ============================================================================
+class SafeLogger {
+private:
+    mutable std::mutex mtx;
+    std::ofstream logFile;
+
+public:
+    SafeLogger(const std::string& filename) {
+        logFile.open(filename, std::ios::app);
+        if (!logFile.is_open()) {
+            throw std::runtime_error("Failed to open log file");
+        }
+    }
+
+    ~SafeLogger() {
+        if (logFile.is_open()) {
+            logFile.close();
+        }
+    }
+
+    SafeLogger(const SafeLogger&) = delete;
+    SafeLogger& operator=(const SafeLogger&) = delete;
+
+    void log(const std::string& message) {
+        std::lock_guard<std::mutex> lock(mtx);
+        logFile << "[" << std::this_thread::get_id() << "] "
+                << message << std::endl;
+    }
+};
+
+// ============================================================================
+// GOOD EXAMPLE: Asynchronous Logger with a Background Writer Thread
+// ============================================================================
+class AsyncLogger {
+private:
+    // Tuning knobs
+    static constexpr std::size_t WAKE_THRESHOLD = 64 * 1024;        // wake writer early
+    static constexpr std::size_t MAX_PENDING = 16 * 1024 * 1024;    // backpressure limit
+    static constexpr std::chrono::milliseconds FLUSH_INTERVAL{100}; // max delay on disk
+
+    // One per logging thread: callers never share a lock with each other,
+    // only with the writer for the O(1) swap
+    struct ThreadBuffer {
+        std::thread::id owner;
+        std::mutex mtx;                // protects front and records
+        std::string front;             // the owning thread appends here
+        unsigned long long records = 0;
+        std::string back;              // being written, touched only by the writer
+    };
+
+    int fd;                        // raw file descriptor, written with write(2)
+    const unsigned long long id;   // tells the thread_local cache which logger it points at
+
+    std::atomic<std::size_t> pendingBytes;         // appended, not yet taken by the writer
+    std::atomic<unsigned long long> appendedSeq;   // number of records appended so far
+
+    std::mutex mtx;                // protects everything below
+    std::condition_variable writerCv;   // wakes the background writer
+    std::condition_variable callerCv;   // wakes callers waiting in flush()/backpressure
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    bool stopping;
+    bool flushRequested;
+    unsigned long long handledSeq;     // records the writer is done with (written or lost)
+    unsigned long long writtenSeq;     // records known to be on disk
+    unsigned long long lostRecords;    // records dropped by failed write(2) calls
+    unsigned long long reportedLost;   // lostRecords already reported by flush()
+    int lastErrno;
+
+    std::thread writer;            // declared last: started after all members
+
+    static unsigned long long nextId() {
+        static std::atomic<unsigned long long> counter{0};
+        return ++counter;
+    }
+
+    // Per-thread cached "[thread id] " prefix: formatting the id once per
+    // thread instead of once per message
+    static const std::string& threadPrefix() {
+        thread_local const std::string prefix = []() {
+            std::ostringstream ss;
+            ss << "[" << std::this_thread::get_id() << "] ";
+            return ss.str();
+        }();
+        return prefix;
+    }
+
+    // The calling thread's buffer; registered under mtx on first use only
+    ThreadBuffer& localBuffer() {
+        thread_local unsigned long long cachedId = 0;
+        thread_local ThreadBuffer* cached = nullptr;
+        if (cachedId == id) {
+            return *cached;
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        std::thread::id self = std::this_thread::get_id();
+        cached = nullptr;
+        for (auto& b : buffers) {
+            if (b->owner == self) cached = b.get();   // thread switched between loggers
+        }
+        if (!cached) {
+            buffers.push_back(std::make_unique<ThreadBuffer>());
+            cached = buffers.back().get();
+            cached->owner = self;
+            cached->front.reserve(WAKE_THRESHOLD);
+        }
+        cachedId = id;
+        return *cached;
+    }
+
+    // write(2) may write less than asked or be interrupted: loop until done.
+    // Returns 0 on success, otherwise the errno of the failed call
+    int writeAll(const std::string& buffer) {
+        const char* p = buffer.data();
+        std::size_t left = buffer.size();
+        while (left > 0) {
+            ssize_t n = ::write(fd, p, left);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return errno;   // disk full / I/O error
+            }
+            p += n;
+            left -= static_cast<std::size_t>(n);
+        }
+        return 0;
+    }
+
+    // Body of the background thread
+    void writerLoop() {
+        std::vector<ThreadBuffer*> snapshot;
+        for (;;) {
+            bool stop;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                writerCv.wait_for(lock, FLUSH_INTERVAL, [this]() {
+                    return stopping || flushRequested || pendingBytes.load() >= WAKE_THRESHOLD;
+                });
+                flushRequested = false;
+                stop = stopping;
+                snapshot.clear();
+                for (auto& b : buffers) snapshot.push_back(b.get());
+            }
+
+            // Drain every thread's buffer: O(1) swap under ITS lock, then
+            // write WITHOUT any lock - callers keep appending meanwhile
+            unsigned long long taken = 0;
+            unsigned long long written = 0;
+            int error = 0;
+            for (ThreadBuffer* b : snapshot) {
+                unsigned long long records;
+                {
+                    std::lock_guard<std::mutex> lock(b->mtx);
+                    b->back.swap(b->front);
+                    records = b->records;
+                    b->records = 0;
+                }
+                if (b->back.empty()) continue;
+                pendingBytes.fetch_sub(b->back.size());
+                int err = writeAll(b->back);
+                b->back.clear();     // keeps capacity: no reallocation next time
+                taken += records;
+                if (err == 0) written += records;
+                else error = err;
+            }
+
+            std::lock_guard<std::mutex> lock(mtx);
+            handledSeq += taken;
+            writtenSeq += written;
+            if (error != 0) {
+                lostRecords += taken - written;
+                lastErrno = error;
+            }
+            callerCv.notify_all();   // wake flush() callers and backpressured callers
+
+            if (stop && taken == 0) {
+                return;
+            }
+        }
+    }
+
+    void append(const char* tag, const std::string& message) {
+        const std::string& prefix = threadPrefix();
+        // Backpressure: the writer is far behind, wait for it
+        if (pendingBytes.load() >= MAX_PENDING) {
+            std::unique_lock<std::mutex> lock(mtx);
+            callerCv.wait(lock, [this]() { return pendingBytes.load() < MAX_PENDING || stopping; });
+        }
+        ThreadBuffer& b = localBuffer();
+        std::size_t size = std::strlen(tag) + prefix.size() + message.size() + 1;
+        std::size_t before;
+        {
+            std::lock_guard<std::mutex> lock(b.mtx);
+            b.front.append(tag);
+            b.front.append(prefix);
+            b.front.append(message);
+            b.front.push_back('\n');
+            ++b.records;
+            // Counted inside the lock: the writer never takes a record (or its
+            // bytes) before they are counted
+            appendedSeq.fetch_add(1);
+            before = pendingBytes.fetch_add(size);
+        }
+        // Only wake the writer when a batch becomes full (no syscall per message)
+        if (before < WAKE_THRESHOLD && before + size >= WAKE_THRESHOLD) {
+            std::lock_guard<std::mutex> lock(mtx);
+            writerCv.notify_one();
+        }
+    }
+
+public:
+    AsyncLogger(const std::string& filename)
+        : fd(-1), id(nextId()), pendingBytes(0), appendedSeq(0), stopping(false),
+          flushRequested(false), handledSeq(0), writtenSeq(0), lostRecords(0),
+          reportedLost(0), lastErrno(0) {
+        fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open log file");
+        }
+        writer = std::thread(&AsyncLogger::writerLoop, this);
+    }
+
+    // Flush-on-destruction: everything logged is written, or reported lost
+    ~AsyncLogger() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        writerCv.notify_one();
+        writer.join();
+        ::close(fd);
+        if (lostRecords > reportedLost) {   // a destructor must not throw
+            std::cerr << "AsyncLogger: " << lostRecords - reportedLost
+                      << " records lost: " << std::strerror(lastErrno) << std::endl;
+        }
+    }
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    // Same interface as SafeLogger
+    void log(const std::string& message) { append("", message); }
+    void logError(const std::string& message) { append("[ERROR]", message); }
+
+    // Blocks until every record logged BEFORE this call is handled.
+    // Throws if any records could not be written since the last report
+    void flush() {
+        unsigned long long target = appendedSeq.load();
+        std::unique_lock<std::mutex> lock(mtx);
+        if (handledSeq < target) {
+            flushRequested = true;
+            writerCv.notify_one();
+            callerCv.wait(lock, [this, target]() { return handledSeq >= target; });
+        }
+        if (lostRecords > reportedLost) {
+            unsigned long long lost = lostRecords - reportedLost;
+            reportedLost = lostRecords;
+            throw std::runtime_error("AsyncLogger: " + std::to_string(lost) +
+                                     " records lost: " + std::strerror(lastErrno));
+        }
+    }
+
+    // Records known to be on disk
+    unsigned long long writtenRecords() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return writtenSeq;
+    }
+};
+
+// ============================================================================
+// BENCHMARK HELPER
+// ============================================================================
+// numThreads threads log messagesPerThread messages each
+// Returns messages per second as seen by the CALLERS
+template <typename Logger>
+double measureLogging(Logger& logger, unsigned numThreads, int messagesPerThread) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&logger, t, messagesPerThread]() {
+            for (int i = 0; i < messagesPerThread; ++i) {
+                logger.log("Message " + std::to_string(i) +
+                           " from thread " + std::to_string(t));
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return numThreads * messagesPerThread / seconds;
+}
+
+// Count lines in a file (to verify nothing was lost)
+long countLines(const std::string& filename) {
+    std::ifstream in(filename);
+    std::string line;
+    long n = 0;
+    while (std::getline(in, line)) ++n;
+    return n;
+}
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: Same workload as demo5_safe_logger, using the async logger
+void demo1_async_logger() {
+    std::cout << "\n=== DEMO 1: Async Logger (3 threads x 50 messages) ===" << std::endl;
+
+    std::remove("app_async.log");
+    {
+        AsyncLogger logger("app_async.log");
+
+        auto logTask = [&logger](int threadNum) {
+            for (int i = 0; i < 50; ++i) {
+                logger.log("Message " + std::to_string(i) +
+                           " from thread " + std::to_string(threadNum));
+            }
+        };
+
+        std::thread t1(logTask, 1);
+        std::thread t2(logTask, 2);
+        std::thread t3(logTask, 3);
+
+        t1.join();
+        t2.join();
+        t3.join();
+
+        logger.flush();   // explicit flush: everything above is now on disk
+        std::cout << "Lines on disk after flush(): " << countLines("app_async.log") << std::endl;
+
+        logger.logError("written by the destructor's final flush");
+    }   // destructor flushes the last record
+    std::cout << "Lines on disk after destruction: " << countLines("app_async.log") << std::endl;
+}
+
+// Demo 2: A failed write(2) is reported, not silently dropped
+// (/dev/full accepts open() but fails every write with ENOSPC)
+void demo2_write_errors() {
+    std::cout << "\n=== DEMO 2: Write Errors (logging to /dev/full) ===" << std::endl;
+
+    AsyncLogger logger("/dev/full");
+    for (int i = 0; i < 10; ++i) {
+        logger.log("Message " + std::to_string(i));
+    }
+    try {
+        logger.flush();
+        std::cout << "flush() succeeded (unexpected)" << std::endl;
+    } catch (const std::exception& e) {
+        std::cout << "flush() threw: " << e.what() << std::endl;
+    }
+    std::cout << "Records on disk: " << logger.writtenRecords() << std::endl;
+
+    logger.log("lost after the last flush()");
+    std::cout << "Destructor reports the last record on std::cerr:" << std::endl;
+}
+
+// Demo 3: Throughput of SafeLogger vs AsyncLogger
+void demo3_benchmark() {
+    std::cout << "\n=== DEMO 3: Benchmark (messages/sec seen by callers) ===" << std::endl;
+
+    const int messagesPerThread = 20000;
+
+    std::cout << "threads\tSafeLogger\tAsyncLogger\tAsyncLogger+flush" << std::endl;
+    for (unsigned n = 1; n <= 4; n *= 2) {
+        std::remove("app_sync.log");
+        std::remove("app_async.log");
+        double syncRate, asyncRate, asyncFlushedRate;
+        {
+            SafeLogger logger("app_sync.log");
+            syncRate = measureLogging(logger, n, messagesPerThread);
+        }
+        {
+            AsyncLogger logger("app_async.log");
+            auto start = std::chrono::steady_clock::now();
+            asyncRate = measureLogging(logger, n, messagesPerThread);
+            logger.flush();   // include the cost of getting it onto disk
+            auto end = std::chrono::steady_clock::now();
+            asyncFlushedRate = n * messagesPerThread /
+                               std::chrono::duration<double>(end - start).count();
+        }
+        std::cout << n << "\t" << static_cast<long>(syncRate) << "\t\t"
+                  << static_cast<long>(asyncRate) << "\t\t"
+                  << static_cast<long>(asyncFlushedRate) << std::endl;
+
+        long expected = static_cast<long>(n) * messagesPerThread;
+        if (countLines("app_sync.log") != expected || countLines("app_async.log") != expected) {
+            std::cout << "ERROR: lost log lines!" << std::endl;
+        }
+    }
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== ASYNC LOGGER DEMONSTRATIONS ===" << std::endl;
+
+    demo1_async_logger();
+    demo2_write_errors();
+    demo3_benchmark();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// TRADE-OFFS
+// ============================================================================
+/*
+WHAT YOU GAIN:
+- Callers pay for one memcpy under their OWN short lock instead of a
+  system call under a lock shared by everybody
+- The disk sees a few large writes instead of thousands of tiny ones
+
+WHAT YOU GIVE UP:
+- A crash can lose up to FLUSH_INTERVAL worth of records that were logged
+  but not yet written -> call flush() before anything critical
+  (e.g. before abort() or after logging a fatal error)
+- Log records are in memory for a short time: memory use grows with the
+  logging rate (bounded by MAX_PENDING)
+*/
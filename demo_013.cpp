@@ -0,0 +1,541 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <queue>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <chrono>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+
+// ============================================================================
+// LESSON: FIXED-SIZE THREAD POOL
+// ============================================================================
+/*
+THE PROBLEM: ONE THREAD PER TASK
+- demo_007.cpp starts 17 std::threads for 17 tiny read/write operations
+- demo_003.cpp, demo_004.cpp and demo_005.cpp also start a new thread for
+  every unit of work - all of them are ported onto the pool below
+- Creating and joining a thread costs tens of microseconds (kernel calls,
+  stack allocation, scheduler bookkeeping) - often MORE than the work itself
+- Starting 10000 threads at once over-subscribes the CPU
+
+THE SOLUTION: A THREAD POOL
+- Start a FIXED number of worker threads once (hardware_concurrency())
+- Work is submitted as TASKS into a shared queue
+- Idle workers take the next task from the queue
+- submit() returns a std::future: the caller can wait for the result
+  (or for an exception thrown by the task)
+
+        submit(task) ──► [ task queue ] ──► worker 1
+        submit(task) ──►                ──► worker 2
+        submit(task) ──►                ──► worker N
+*/
+
+// ============================================================================
+// GOOD EXAMPLE: Thread Pool with submit() Returning a Future
+// ============================================================================
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+
+    std::mutex mtx;                 // protects 'tasks' and 'stopping'
+    std::condition_variable cv;     // signals "task available" or "stopping"
+    bool stopping;
+
+    // Every worker runs this loop until the pool is destroyed
+    void workerLoop() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty()) {
+                    return;   // finish remaining tasks before exiting
+                }
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            // Run the task WITHOUT holding the lock
+            task();
+        }
+    }
+
+public:
+    // Default size: one worker per hardware thread
+    explicit ThreadPool(std::size_t numThreads = std::thread::hardware_concurrency())
+        : stopping(false) {
+        numThreads = std::max<std::size_t>(numThreads, 1);  // hardware_concurrency() may be 0
+        for (std::size_t i = 0; i < numThreads; ++i) {
+            workers.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+
+    // Destructor: runs all queued tasks, then joins every worker
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (auto& w : workers) {
+            w.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Submit any callable with arguments - like the std::thread constructor
+    // Returns a future for the callable's return value
+    template <typename F, typename... Args>
+    auto submit(F&& f, Args&&... args)
+        -> std::future<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>> {
+        using Result = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+
+        // packaged_task connects the callable to the future
+        // It is move-only, but std::function needs a copyable callable,
+        // so we keep it in a shared_ptr.
+        // The callable and arguments are stored by value (decayed, like
+        // std::thread) and MOVED into the call: move-only arguments work
+        auto task = std::make_shared<std::packaged_task<Result()>>(
+            [fn = std::decay_t<F>(std::forward<F>(f)),
+             params = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+                return std::apply(std::move(fn), std::move(params));
+            });
+        std::future<Result> result = task->get_future();
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (stopping) {
+                throw std::runtime_error("submit() on a stopped ThreadPool");
+            }
+            tasks.emplace([task]() { (*task)(); });
+        }
+        cv.notify_one();
+        return result;
+    }
+
+    std::size_t size() const { return workers.size(); }
+};
+
+// ============================================================================
+// WORKLOADS PORTED FROM EARLIER DEMOS
+// ============================================================================
+
+// From demo_004.cpp: RAII-protected console output
+std::mutex coutMtx;
+void dispMessage2(const std::string& s) {
+    std::lock_guard<std::mutex> lock(coutMtx);
+    std::cout << s << std::endl;
+}
+
+// From demo_004.cpp: func3 (a plain function, launched by pointer)
+// (5 lines instead of 100 to keep the output short)
+void func3() {
+    for (int i = 0; i < 5; i++) {
+        dispMessage2("T2 ---");
+    }
+}
+
+// From demo_004.cpp: the mutex is bound to the resource it protects
+class Logger {
+    std::mutex mtx;
+    std::ofstream f;
+
+public:
+    explicit Logger(const std::string& filename) { f.open(filename); }
+
+    void log(const std::string& s) {
+        std::lock_guard<std::mutex> lock(mtx);
+        f << s << std::endl;
+    }
+};
+
+// From demo_004.cpp: func4 writes through a Logger passed by reference
+void func4(Logger& logger) {
+    for (int i = 0; i < 100; i++) {
+        logger.log("T1 ---");
+    }
+}
+
+// From demo_003.cpp: the class behind every launch variant
+// (func1 prints through dispMessage2: tasks may run concurrently)
+class MYCLASS {
+public:
+    void func1(int i, std::string s) { dispMessage2(std::to_string(i) + " " + s); }
+    int operator()(int x) { return x * 10; }
+    void operator()() {}
+};
+
+// From demo_005.cpp: the stack used by demo4_safe_stack
+class SafeStack {
+private:
+    mutable std::mutex mtx;
+    std::vector<int> data;
+
+public:
+    void push(int value) {
+        std::lock_guard<std::mutex> lock(mtx);
+        data.push_back(value);
+    }
+
+    bool tryPop(int& result) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (data.empty()) {
+            return false;
+        }
+        result = data.back();
+        data.pop_back();
+        return true;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return data.size();
+    }
+};
+
+// From demo_005.cpp: the logger used by demo5_safe_logger
+class SafeLogger {
+private:
+    mutable std::mutex mtx;
+    std::ofstream logFile;
+
+public:
+    SafeLogger(const std::string& filename) {
+        logFile.open(filename);
+        if (!logFile.is_open()) {
+            throw std::runtime_error("Failed to open log file");
+        }
+    }
+
+    SafeLogger(const SafeLogger&) = delete;
+    SafeLogger& operator=(const SafeLogger&) = delete;
+
+    void log(const std::string& message) {
+        std::lock_guard<std::mutex> lock(mtx);
+        logFile << "[" << std::this_thread::get_id() << "] "
+                << message << std::endl;
+    }
+};
+
+// From demo_005.cpp: the counter used by demo6_safe_counter
+class SafeCounter {
+private:
+    mutable std::mutex mtx;
+    int count;
+
+public:
+    SafeCounter() : count(0) {}
+
+    void increment() {
+        std::lock_guard<std::mutex> lock(mtx);
+        ++count;
+    }
+
+    int getCount() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return count;
+    }
+};
+
+// Counts the lines of a log file written by a demo
+int countLines(const std::string& filename) {
+    std::ifstream in(filename);
+    std::string line;
+    int lines = 0;
+    while (std::getline(in, line)) ++lines;
+    return lines;
+}
+
+// From demo_007.cpp: read_correct / write_correct
+// (sleep times shortened from 500ms/100ms to keep the demo fast)
+std::shared_mutex sh_mutex;
+
+void write_correct(int i) {
+    std::unique_lock<std::shared_mutex> lock(sh_mutex);
+    dispMessage2("WRITER task " + std::to_string(i) + " - exclusive access");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+}
+
+void read_correct(int i) {
+    std::shared_lock<std::shared_mutex> lock(sh_mutex);
+    dispMessage2("READER task " + std::to_string(i) + " - shared access");
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+}
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: submit() with return values and exceptions
+void demo1_futures() {
+    std::cout << "\n=== DEMO 1: submit() Returns a Future ===" << std::endl;
+
+    ThreadPool pool;
+    std::cout << "Pool size: " << pool.size() << " worker(s)" << std::endl;
+
+    // Like std::thread: functions, lambdas and arguments all work
+    std::future<int> sum = pool.submit([](int a, int b) { return a + b; }, 20, 22);
+    std::future<std::string> text = pool.submit([](std::string s) { return s + s; }, std::string("CO"));
+
+    std::cout << "20 + 22 = " << sum.get() << std::endl;
+    std::cout << "\"CO\" doubled = " << text.get() << std::endl;
+
+    // Move-only arguments are moved into the task, as with std::thread
+    std::future<int> owned = pool.submit([](std::unique_ptr<int> p) { return *p; }, std::make_unique<int>(7));
+    std::cout << "Value from a unique_ptr argument = " << owned.get() << std::endl;
+
+    // An exception thrown inside a task is re-thrown by future::get()
+    std::future<void> failing = pool.submit([]() { throw std::runtime_error("task failed"); });
+    try {
+        failing.get();
+    } catch (const std::exception& e) {
+        std::cout << "Caught from task: " << e.what() << std::endl;
+    }
+}
+
+// Demo 2: demo_003.cpp's thread-creation variants as pool tasks
+void demo2_launch_variants_on_pool() {
+    std::cout << "\n=== DEMO 2: demo_003 Launch Variants on the Pool ===" << std::endl;
+
+    MYCLASS cl;
+    MYCLASS obj;
+    ThreadPool pool;            // declared after the data, destroyed before it
+
+    // T1-T3: functor by copy, by reference, by move - operator()(int)
+    std::future<int> t1 = pool.submit(cl, 1);
+    std::future<int> t2 = pool.submit(std::ref(cl), 2);
+    std::future<int> t3 = pool.submit(std::move(cl), 3);
+
+    // T5: temporary functor, operator()()
+    // (T4 in demo_003.cpp passes (4, "aaaa"), which matches no operator())
+    std::future<void> t5 = pool.submit(MYCLASS());
+
+    // T6: lambda - its return value is no longer thrown away
+    std::future<std::string> t6 = pool.submit([](std::string s) { return s + s; }, std::string("CO"));
+
+    // T7 / T8: member function on a copy and through a pointer
+    std::future<void> t7 = pool.submit(&MYCLASS::func1, obj, 7, std::string("CO"));
+    std::future<void> t8 = pool.submit(&MYCLASS::func1, &obj, 8, std::string("CO"));
+
+    // Plain function pointer (func3 from demo_004.cpp)
+    std::future<void> t9 = pool.submit(&func3);
+
+    // Every task is waited for - the unjoined threads of demo_003.cpp
+    // cannot happen here
+    int r1 = t1.get();
+    int r2 = t2.get();
+    int r3 = t3.get();
+    t5.get();
+    std::string r6 = t6.get();
+    t7.get();
+    t8.get();
+    t9.get();
+    std::cout << "T1-T3 returned " << r1 << ", " << r2 << ", " << r3 << std::endl;
+    std::cout << "T6 returned " << r6 << std::endl;
+}
+
+// Demo 3: demo_004.cpp's logger fan-out on the pool
+void demo3_logger_on_pool() {
+    std::cout << "\n=== DEMO 3: demo_004 Logger on the Pool ===" << std::endl;
+
+    const std::string filename = "pool_app.log";
+    {
+        Logger logger(filename);
+        ThreadPool pool;        // declared last, destroyed first
+
+        // demo4() in demo_004.cpp: func4 on a thread, "--- main" from main.
+        // Both halves are tasks now
+        std::future<void> worker = pool.submit(func4, std::ref(logger));
+        std::future<void> mainPart = pool.submit([&logger]() {
+            for (int i = 0; i > -100; --i) {
+                logger.log("--- main");
+            }
+        });
+        worker.get();
+        mainPart.get();
+    }
+
+    std::cout << "Lines in " << filename << ": " << countLines(filename) << " (expected 200)" << std::endl;
+}
+
+// Demo 4: demo_005.cpp's thread-per-task demos on the pool
+// (demo1_unsafe is left out: its data race is the point of that lesson)
+void demo4_safe_classes_on_pool() {
+    std::cout << "\n=== DEMO 4: demo_005 Safe Stack, Logger and Counter on the Pool ===" << std::endl;
+
+    const std::string filename = "pool_safe.log";
+    SafeStack stack;
+    SafeCounter counter;
+    long sum = 0;
+    {
+        SafeLogger logger(filename);
+        ThreadPool pool;        // declared last, destroyed first
+
+        // demo4_safe_stack: producer and consumer are tasks
+        std::future<void> producer = pool.submit([&stack]() {
+            for (int i = 0; i < 100; ++i) {
+                stack.push(i);
+            }
+        });
+        std::future<void> consumer = pool.submit([&stack, &sum]() {
+            int value;
+            while (stack.tryPop(value)) {
+                sum += value;
+            }
+            // Try a bit more to catch items still being produced
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            while (stack.tryPop(value)) {
+                sum += value;
+            }
+        });
+
+        // demo5_safe_logger: three logging tasks instead of three threads
+        auto logTask = [&logger](int taskNum) {
+            for (int i = 0; i < 50; ++i) {
+                logger.log("Message " + std::to_string(i) +
+                           " from task " + std::to_string(taskNum));
+            }
+        };
+        std::vector<std::future<void>> logs;
+        for (int t = 1; t <= 3; ++t) {
+            logs.push_back(pool.submit(logTask, t));
+        }
+
+        // demo6_safe_counter: two tasks instead of two threads
+        auto incrementTask = [&counter]() {
+            for (int i = 0; i < 10000; ++i) {
+                counter.increment();
+            }
+        };
+        std::future<void> f1 = pool.submit(incrementTask);
+        std::future<void> f2 = pool.submit(incrementTask);
+
+        producer.get();
+        consumer.get();
+        for (auto& f : logs) f.get();
+        f1.get();
+        f2.get();
+    }
+
+    std::cout << "Stack: sum of popped items " << sum << " (expected 4950), remaining "
+              << stack.size() << std::endl;
+    std::cout << "Logger: lines in " << filename << ": " << countLines(filename) << " (expected 150)" << std::endl;
+    std::cout << "Counter: expected 20000, actual " << counter.getCount() << std::endl;
+}
+
+// Demo 5: demo_corrected (demo_007.cpp) on the pool
+void demo5_readers_writers_on_pool() {
+    std::cout << "\n=== DEMO 5: Readers and Writers on the Pool ===" << std::endl;
+
+    ThreadPool pool;
+    std::vector<std::future<void>> results;
+
+    // Same fan-out as demo_corrected: 5 readers, 2 writers, 10 readers
+    // but 17 TASKS instead of 17 THREADS
+    for (int i = 0; i < 5; ++i)
+        results.push_back(pool.submit(read_correct, i));
+    results.push_back(pool.submit(write_correct, 5));
+    results.push_back(pool.submit(write_correct, 6));
+    for (int i = 0; i < 10; ++i)
+        results.push_back(pool.submit(read_correct, i + 7));
+
+    for (auto& r : results)
+        r.get();
+
+    std::cout << "Note: readers only overlap when the pool has more than one worker" << std::endl;
+}
+
+// Demo 6: Tasks per second - spawn-per-task vs pooled
+void demo6_benchmark() {
+    std::cout << "\n=== DEMO 6: Benchmark (tiny tasks/sec) ===" << std::endl;
+
+    const int numTasks = 5000;
+    SafeCounter counter;
+    auto tinyTask = [&counter]() { counter.increment(); };
+
+    // A: one std::thread per task (the pattern used in the earlier demos)
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < numTasks; ++i) {
+        std::thread t(tinyTask);
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    double spawnRate = numTasks / std::chrono::duration<double>(end - start).count();
+
+    // B: all tasks submitted to one pool
+    double pooledRate;
+    {
+        ThreadPool pool;
+        std::vector<std::future<void>> results;
+        results.reserve(numTasks);
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < numTasks; ++i) {
+            results.push_back(pool.submit(tinyTask));
+        }
+        for (auto& r : results) {
+            r.get();
+        }
+        end = std::chrono::steady_clock::now();
+        pooledRate = numTasks / std::chrono::duration<double>(end - start).count();
+    }
+
+    std::cout << "spawn-per-task: " << static_cast<long>(spawnRate) << " tasks/sec" << std::endl;
+    std::cout << "thread pool:    " << static_cast<long>(pooledRate) << " tasks/sec" << std::endl;
+    std::cout << "Counter (expected " << 2 * numTasks << "): " << counter.getCount() << std::endl;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== THREAD POOL DEMONSTRATIONS ===" << std::endl;
+
+    demo1_futures();
+    demo2_launch_variants_on_pool();
+    demo3_logger_on_pool();
+    demo4_safe_classes_on_pool();
+    demo5_readers_writers_on_pool();
+    demo6_benchmark();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// THREAD POOL PITFALLS
+// ============================================================================
+/*
+1. BLOCKING TASKS
+   - A task that sleeps or waits for I/O occupies a worker the whole time
+   - With N workers, N sleeping tasks stall the entire pool (see Demo 5)
+   - Use a separate pool for blocking work, or make the work asynchronous
+
+2. TASKS WAITING FOR OTHER TASKS
+   - A task that calls future::get() on a task queued BEHIND it can
+     deadlock a pool where every worker is doing the same
+   - Use a work-stealing scheduler for fork/join workloads (next lesson)
+
+3. ONE SHARED QUEUE
+   - Every submit() and every worker touches the same mutex
+   - Fine for tasks of microseconds or more; for nanosecond tasks use
+     per-worker queues or batch the work
+
+4. DESTRUCTION ORDER
+   - Tasks must not outlive the data they capture by reference
+   - Declare the data BEFORE the pool: members and locals are destroyed
+     in reverse order, so the pool finishes its tasks before the data dies
+*/
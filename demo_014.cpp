@@ -0,0 +1,558 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <deque>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <exception>
+#include <cstdint>
+#include <algorithm>
+
+// ============================================================================
+// LESSON: WORK-STEALING SCHEDULER (CHASE-LEV DEQUES)
+// ============================================================================
+/*
+THE PROBLEM WITH ONE SHARED QUEUE (demo_013.cpp):
+- Every submit() and every worker locks the SAME mutex
+- Recursive (fork/join) work is the worst case: a task that spawns 2
+  subtasks, which spawn 2 more... floods the global queue, and a task that
+  waits for its children can block a worker forever
+
+WORK STEALING (Cilk, TBB, Java ForkJoinPool, Go, Tokio):
+- Every worker OWNS a double-ended queue (deque)
+- The owner pushes and pops at the BOTTOM (LIFO: hot in its cache)
+- Idle workers STEAL from the TOP of someone else's deque (the oldest,
+  usually biggest, piece of work)
+- Tasks spawned from inside a task stay on the local deque: no global lock
+
+          worker 0 deque             worker 1 deque
+        top -> [ big   ]  <── steal ── (idle worker 1)
+               [ medium]
+     bottom -> [ small ]  <── push/pop (worker 0 only)
+
+CHASE-LEV DEQUE (Chase & Lev 2005, C11 version by Le et al. 2013):
+- Lock-free: owner and thieves only use atomics
+- The owner's push/pop usually needs NO atomic read-modify-write at all
+- Only when owner and thief race for the LAST element do they use a CAS
+*/
+
+// ============================================================================
+// CHASE-LEV WORK-STEALING DEQUE
+// ============================================================================
+template <typename T>
+class ChaseLevDeque {
+private:
+    // Circular buffer; replaced by a bigger one when full
+    struct Array {
+        std::int64_t capacity;
+        std::unique_ptr<std::atomic<T>[]> items;
+
+        explicit Array(std::int64_t cap) : capacity(cap), items(new std::atomic<T>[cap]) {}
+
+        T get(std::int64_t i) const {
+            return items[i & (capacity - 1)].load(std::memory_order_relaxed);
+        }
+        void put(std::int64_t i, T x) {
+            items[i & (capacity - 1)].store(x, std::memory_order_relaxed);
+        }
+    };
+
+    alignas(64) std::atomic<std::int64_t> top;     // thieves take from here
+    alignas(64) std::atomic<std::int64_t> bottom;  // owner pushes/pops here
+    std::atomic<Array*> array;
+
+    // Old arrays may still be read by a thief: keep them until destruction
+    std::vector<std::unique_ptr<Array>> retired;
+
+    Array* grow(Array* old, std::int64_t b, std::int64_t t) {
+        Array* bigger = new Array(old->capacity * 2);
+        for (std::int64_t i = t; i < b; ++i) {
+            bigger->put(i, old->get(i));
+        }
+        retired.emplace_back(old);
+        array.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+public:
+    explicit ChaseLevDeque(std::int64_t initialCapacity = 256)
+        : top(0), bottom(0), array(new Array(initialCapacity)) {}
+
+    ~ChaseLevDeque() {
+        delete array.load(std::memory_order_relaxed);
+    }
+
+    ChaseLevDeque(const ChaseLevDeque&) = delete;
+    ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+    // OWNER ONLY
+    void push(T x) {
+        std::int64_t b = bottom.load(std::memory_order_relaxed);
+        std::int64_t t = top.load(std::memory_order_acquire);
+        Array* a = array.load(std::memory_order_relaxed);
+        if (b - t > a->capacity - 1) {
+            a = grow(a, b, t);
+        }
+        a->put(b, x);
+        bottom.store(b + 1, std::memory_order_release);   // publishes x to thieves
+    }
+
+    // OWNER ONLY: returns false if empty
+    bool pop(T& out) {
+        std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Array* a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            // Deque was empty: restore bottom
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        out = a->get(b);
+        if (t == b) {
+            // Last element: race against thieves with a CAS on top
+            bool won = top.compare_exchange_strong(t, t + 1,
+                                                   std::memory_order_seq_cst,
+                                                   std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // ANY THREAD: returns false if empty or if another thread won the race
+    bool steal(T& out) {
+        std::int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false;
+        }
+        Array* a = array.load(std::memory_order_acquire);
+        T x = a->get(t);
+        if (!top.compare_exchange_strong(t, t + 1,
+                                         std::memory_order_seq_cst,
+                                         std::memory_order_relaxed)) {
+            return false;   // lost the race: the caller may try another victim
+        }
+        out = x;
+        return true;
+    }
+
+    bool looksEmpty() const {
+        return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+    }
+};
+
+// ============================================================================
+// WORK-STEALING SCHEDULER
+// ============================================================================
+class WorkStealingScheduler {
+public:
+    using Task = std::function<void()>;
+
+private:
+    struct alignas(64) Worker {
+        ChaseLevDeque<Task*> deque;
+        std::atomic<long> stolen{0};   // statistics only
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    // Tasks submitted from OUTSIDE the pool (e.g. from main) go here
+    std::mutex injectMtx;
+    std::deque<Task*> injected;
+
+    // Parking for idle workers - only touched when workers run out of work
+    std::mutex idleMtx;
+    std::condition_variable idleCv;
+    std::atomic<int> sleepers{0};
+    std::atomic<bool> stopping{false};
+
+    // Which scheduler/worker the current thread belongs to (if any)
+    static thread_local WorkStealingScheduler* currentScheduler;
+    static thread_local std::size_t currentWorker;
+
+    bool onWorkerThread() const { return currentScheduler == this; }
+
+    static std::size_t randomVictim(std::size_t bound) {
+        thread_local std::uint32_t seed =
+            static_cast<std::uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1u;
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed % bound;
+    }
+
+    bool takeInjected(Task*& task) {
+        std::lock_guard<std::mutex> lock(injectMtx);
+        if (injected.empty()) return false;
+        task = injected.front();
+        injected.pop_front();
+        return true;
+    }
+
+    // Try every other worker once, starting at a random victim
+    bool stealAny(Task*& task, std::size_t self) {
+        std::size_t n = workers.size();
+        std::size_t start = randomVictim(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            std::size_t victim = (start + i) % n;
+            if (victim == self) continue;
+            if (workers[victim]->deque.steal(task)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool anyWorkVisible() {
+        for (auto& w : workers) {
+            if (!w->deque.looksEmpty()) return true;
+        }
+        std::lock_guard<std::mutex> lock(injectMtx);
+        return !injected.empty();
+    }
+
+    // Wake a parked worker, but only if somebody is actually parked
+    void wakeOne() {
+        // Pairs with the seq_cst increment of 'sleepers' in park():
+        // either we see the sleeper, or the sleeper sees our new task
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_relaxed) > 0) {
+            { std::lock_guard<std::mutex> lock(idleMtx); }
+            idleCv.notify_one();
+        }
+    }
+
+    void park() {
+        std::unique_lock<std::mutex> lock(idleMtx);
+        sleepers.fetch_add(1, std::memory_order_seq_cst);
+        // Re-check after announcing ourselves: a task may have been pushed
+        // just before the increment became visible
+        if (!stopping.load() && !anyWorkVisible()) {
+            idleCv.wait_for(lock, std::chrono::milliseconds(10));
+        }
+        sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    static void runTask(Task* task) {
+        (*task)();
+        delete task;
+    }
+
+    void workerLoop(std::size_t self) {
+        currentScheduler = this;
+        currentWorker = self;
+        int idleRounds = 0;
+
+        while (!stopping.load(std::memory_order_acquire)) {
+            if (runOneTask()) {
+                idleRounds = 0;
+            } else if (++idleRounds < 64) {
+                std::this_thread::yield();
+            } else {
+                park();
+                idleRounds = 0;
+            }
+        }
+        currentScheduler = nullptr;
+    }
+
+public:
+    explicit WorkStealingScheduler(std::size_t numWorkers = std::thread::hardware_concurrency()) {
+        numWorkers = std::max<std::size_t>(numWorkers, 1);
+        for (std::size_t i = 0; i < numWorkers; ++i) {
+            workers.emplace_back(new Worker);
+        }
+        for (std::size_t i = 0; i < numWorkers; ++i) {
+            threads.emplace_back(&WorkStealingScheduler::workerLoop, this, i);
+        }
+    }
+
+    // Callers must wait for their tasks (TaskGroup::wait) before destruction
+    ~WorkStealingScheduler() {
+        stopping.store(true, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(idleMtx);
+        }
+        idleCv.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    WorkStealingScheduler(const WorkStealingScheduler&) = delete;
+    WorkStealingScheduler& operator=(const WorkStealingScheduler&) = delete;
+
+    // From a worker: push to the LOCAL deque (no lock)
+    // From any other thread: push to the injection queue
+    void spawn(Task fn) {
+        Task* task = new Task(std::move(fn));
+        if (onWorkerThread()) {
+            workers[currentWorker]->deque.push(task);
+        } else {
+            std::lock_guard<std::mutex> lock(injectMtx);
+            injected.push_back(task);
+        }
+        wakeOne();
+    }
+
+    // Run one pending task if there is one (used by workers and by waiters)
+    bool runOneTask() {
+        Task* task = nullptr;
+        if (onWorkerThread()) {
+            std::size_t self = currentWorker;
+            if (workers[self]->deque.pop(task)) {          // 1. own work (LIFO)
+                runTask(task);
+                return true;
+            }
+            if (stealAny(task, self)) {                     // 2. steal (FIFO end)
+                workers[self]->stolen.fetch_add(1, std::memory_order_relaxed);
+                runTask(task);
+                return true;
+            }
+            if (takeInjected(task)) {                       // 3. external work
+                runTask(task);
+                return true;
+            }
+            return false;
+        }
+        // Non-worker thread (e.g. main waiting in TaskGroup::wait): help out
+        if (takeInjected(task) || stealAny(task, workers.size())) {
+            runTask(task);
+            return true;
+        }
+        return false;
+    }
+
+    std::size_t size() const { return workers.size(); }
+
+    long totalStolen() const {
+        long n = 0;
+        for (auto& w : workers) n += w->stolen.load(std::memory_order_relaxed);
+        return n;
+    }
+};
+
+thread_local WorkStealingScheduler* WorkStealingScheduler::currentScheduler = nullptr;
+thread_local std::size_t WorkStealingScheduler::currentWorker = 0;
+
+// ============================================================================
+// FORK/JOIN HELPER
+// ============================================================================
+// run() forks a child task, wait() joins all children
+// wait() never just blocks: it runs other tasks while children are pending,
+// so a worker waiting for its children keeps doing useful work
+class TaskGroup {
+private:
+    WorkStealingScheduler& scheduler;
+    std::atomic<long> pending{0};
+    std::mutex errorMtx;
+    std::exception_ptr error;
+
+public:
+    explicit TaskGroup(WorkStealingScheduler& s) : scheduler(s) {}
+
+    ~TaskGroup() {
+        // Never leave children running with a dangling 'this'
+        while (pending.load(std::memory_order_acquire) > 0) {
+            if (!scheduler.runOneTask()) std::this_thread::yield();
+        }
+    }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template <typename F>
+    void run(F&& f) {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        scheduler.spawn([this, fn = std::forward<F>(f)]() mutable {
+            try {
+                fn();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMtx);
+                if (!error) error = std::current_exception();
+            }
+            pending.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    // Re-throws the first exception thrown by a child
+    void wait() {
+        while (pending.load(std::memory_order_acquire) > 0) {
+            if (!scheduler.runOneTask()) {
+                std::this_thread::yield();
+            }
+        }
+        std::lock_guard<std::mutex> lock(errorMtx);
+        if (error) {
+            std::exception_ptr e = error;
+            error = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+};
+
+// ============================================================================
+// WORKLOADS
+// ============================================================================
+
+// Recursive Fibonacci: the classic fork/join benchmark
+long fibSerial(int n) {
+    return n < 2 ? n : fibSerial(n - 1) + fibSerial(n - 2);
+}
+
+long fibParallel(WorkStealingScheduler& s, int n, int cutoff) {
+    if (n < cutoff) {
+        return fibSerial(n);   // small problems: spawning costs more than it saves
+    }
+    long a = 0;
+    TaskGroup group(s);
+    group.run([&s, &a, n, cutoff]() { a = fibParallel(s, n - 1, cutoff); });  // fork
+    long b = fibParallel(s, n - 2, cutoff);                                  // do half ourselves
+    group.wait();                                                             // join
+    return a + b;
+}
+
+// From demo_007.cpp: readers and writers, now spawned from INSIDE a task
+std::shared_mutex sh_mutex;
+std::mutex coutMtx;
+
+void write_correct(int i) {
+    std::unique_lock<std::shared_mutex> lock(sh_mutex);
+    std::lock_guard<std::mutex> out(coutMtx);
+    std::cout << "WRITER task " << i << " - exclusive access" << std::endl;
+}
+
+void read_correct(int i) {
+    std::shared_lock<std::shared_mutex> lock(sh_mutex);
+    std::lock_guard<std::mutex> out(coutMtx);
+    std::cout << "READER task " << i << " - shared access" << std::endl;
+}
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: Nested fan-out - one parent task spawns the demo_007 readers and
+// writers; they go to the parent worker's local deque, not a global queue
+void demo1_nested_fan_out() {
+    std::cout << "\n=== DEMO 1: Nested Reader/Writer Fan-Out ===" << std::endl;
+
+    WorkStealingScheduler scheduler;
+    TaskGroup outer(scheduler);
+
+    outer.run([&scheduler]() {
+        TaskGroup inner(scheduler);   // children of THIS task
+        for (int i = 0; i < 5; ++i)
+            inner.run([i]() { read_correct(i); });
+        inner.run([]() { write_correct(5); });
+        inner.run([]() { write_correct(6); });
+        for (int i = 0; i < 10; ++i)
+            inner.run([i]() { read_correct(i + 7); });
+        inner.wait();
+    });
+    outer.wait();
+
+    std::cout << "Workers: " << scheduler.size()
+              << ", tasks stolen: " << scheduler.totalStolen() << std::endl;
+}
+
+// Demo 2: Exceptions travel from a child task to wait()
+void demo2_exceptions() {
+    std::cout << "\n=== DEMO 2: Exception Propagation ===" << std::endl;
+
+    WorkStealingScheduler scheduler;
+    TaskGroup group(scheduler);
+    group.run([]() { throw std::runtime_error("child task failed"); });
+    try {
+        group.wait();
+    } catch (const std::exception& e) {
+        std::cout << "Caught in wait(): " << e.what() << std::endl;
+    }
+}
+
+// Demo 3: Fork/join scaling benchmark
+void demo3_benchmark() {
+    std::cout << "\n=== DEMO 3: Benchmark (parallel fib) ===" << std::endl;
+
+    const int n = 32;
+    const int cutoff = 20;
+
+    auto start = std::chrono::steady_clock::now();
+    long expected = fibSerial(n);
+    auto end = std::chrono::steady_clock::now();
+    double serialMs = std::chrono::duration<double, std::milli>(end - start).count();
+    std::cout << "serial fib(" << n << ") = " << expected << " in " << serialMs << " ms" << std::endl;
+
+    // 1, 2, 4 ... workers, always ending with every hardware thread
+    unsigned maxWorkers = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> workerCounts;
+    for (unsigned w = 1; w < maxWorkers; w *= 2) workerCounts.push_back(w);
+    workerCounts.push_back(maxWorkers);
+
+    std::cout << "workers\tms\tspeedup\tstolen" << std::endl;
+    for (unsigned w : workerCounts) {
+        WorkStealingScheduler scheduler(w);
+        long result = 0;
+
+        start = std::chrono::steady_clock::now();
+        {
+            TaskGroup root(scheduler);
+            root.run([&scheduler, &result, n, cutoff]() { result = fibParallel(scheduler, n, cutoff); });
+            root.wait();
+        }
+        end = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+        std::cout << w << "\t" << ms << "\t" << serialMs / ms << "\t"
+                  << scheduler.totalStolen() << std::endl;
+        if (result != expected) {
+            std::cout << "ERROR: wrong result " << result << std::endl;
+        }
+    }
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== WORK-STEALING SCHEDULER DEMONSTRATIONS ===" << std::endl;
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+
+    demo1_nested_fan_out();
+    demo2_exceptions();
+    demo3_benchmark();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// WHY LIFO FOR THE OWNER, FIFO FOR THIEVES?
+// ============================================================================
+/*
+OWNER POPS THE NEWEST TASK (bottom):
+- It was just created, its data is still in this core's cache
+- In fork/join it is the SMALLEST piece: finishing it quickly keeps the
+  deque short (memory use stays O(depth) instead of O(tasks))
+
+THIEF STEALS THE OLDEST TASK (top):
+- In fork/join it is the BIGGEST piece (closest to the root)
+- One steal moves a lot of work -> few steals are needed in total
+- Thief and owner work at opposite ends: they rarely touch the same entry
+
+HELP-FIRST JOIN:
+- TaskGroup::wait() runs other tasks instead of blocking
+- A waiting worker can never deadlock the pool the way future::get()
+  inside a shared-queue pool can
+*/
@@ -0,0 +1,532 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+
+// ============================================================================
+// LESSON: MEASURING SYNCHRONIZATION PRIMITIVES
+// ============================================================================
+/*
+WHY A HARNESS?
+- The demos print to std::cout with hard-coded loop counts (100, 1000, 10000)
+- "It feels faster" is not a measurement: without numbers we cannot tell
+  whether a change helps, hurts, or does nothing
+
+WHAT A USEFUL BENCHMARK REPORTS:
+- THROUGHPUT (ops/sec): how much work gets done in total
+- LATENCY PERCENTILES (p50/p99/p999): how long ONE operation takes
+    p50  = the typical operation
+    p99  = 1 in 100 operations is slower than this
+    p999 = 1 in 1000 - lock convoys and preemptions show up here
+- Averages hide tail latency: one 10ms stall among 10000 fast operations
+  barely moves the mean but ruins p999
+
+METHODOLOGY USED HERE:
+- WARMUP: run some iterations untimed first (caches, page faults, CPU clocks)
+- REPETITIONS: run the whole measurement several times, report the median
+- Every thread starts at the same moment (start barrier)
+- Fresh state for every repetition
+
+USAGE:
+    ./demo_015 [--threads N] [--iters N] [--warmup N] [--reps N]
+               [--format text|json|csv] [--filter SUBSTRING] [--list]
+*/
+
+// ============================================================================
+// PRIMITIVES UNDER TEST (copied from demo_004 ... demo_007)
+// ============================================================================
+
+// A stream that formats but throws the characters away
+// Lets us measure the locking around std::cout-style output without
+// flooding the terminal
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+NullBuffer nullBuffer;
+std::ostream nullOut(&nullBuffer);
+
+// From demo_004.cpp
+typedef std::mutex mutex_t;
+mutex_t mtx;
+
+void dispMessage2(const std::string& s) {
+    std::lock_guard<std::mutex> lock(mtx);
+    nullOut << s << std::endl;   // demo_004 writes to std::cout
+}
+
+// From demo_005.cpp
+class SafeStack {
+private:
+    mutable std::mutex mtx;
+    std::vector<int> data;
+
+public:
+    void push(int value) {
+        std::lock_guard<std::mutex> lock(mtx);
+        data.push_back(value);
+    }
+
+    bool tryPop(int& result) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (data.empty()) {
+            return false;
+        }
+        result = data.back();
+        data.pop_back();
+        return true;
+    }
+};
+
+class SafeCounter {
+private:
+    mutable std::mutex mtx;
+    int count;
+
+public:
+    SafeCounter() : count(0) {}
+
+    void increment() {
+        std::lock_guard<std::mutex> lock(mtx);
+        ++count;
+    }
+
+    int getCount() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return count;
+    }
+};
+
+class SafeLogger {
+private:
+    mutable std::mutex mtx;
+    std::ofstream logFile;
+
+public:
+    SafeLogger(const std::string& filename) {
+        logFile.open(filename, std::ios::app);
+        if (!logFile.is_open()) {
+            throw std::runtime_error("Failed to open log file");
+        }
+    }
+
+    SafeLogger(const SafeLogger&) = delete;
+    SafeLogger& operator=(const SafeLogger&) = delete;
+
+    void log(const std::string& message) {
+        std::lock_guard<std::mutex> lock(mtx);
+        logFile << "[" << std::this_thread::get_id() << "] "
+                << message << std::endl;
+    }
+};
+
+// From demo_006.cpp (output goes to nullOut instead of std::cout)
+class Logger1 {
+    std::mutex mtx;
+    std::mutex mtx2;
+
+public:
+    void log(const std::string& s) {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::lock_guard<std::mutex> lock2(mtx2);
+        nullOut << s << std::endl;
+    }
+    // log2() locks in the opposite order and deadlocks: not benchmarked
+};
+
+class Logger2 {
+    std::mutex mtx;
+    std::mutex mtx2;
+
+public:
+    void log(const std::string& s) {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::lock_guard<std::mutex> lock2(mtx2);
+        nullOut << s << std::endl;
+    }
+
+    void log2(const std::string& s) {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::lock_guard<std::mutex> lock2(mtx2);
+        nullOut << s << std::endl;
+    }
+};
+
+class Logger3 {
+    std::mutex mtx;
+    std::mutex mtx2;
+
+public:
+    void log(const std::string& s) {
+        std::lock(mtx, mtx2);
+        std::lock_guard<std::mutex> lock(mtx, std::adopt_lock);
+        std::lock_guard<std::mutex> lock2(mtx2, std::adopt_lock);
+        nullOut << s << std::endl;
+    }
+
+    void log2(const std::string& s) {
+        std::lock(mtx, mtx2);
+        std::lock_guard<std::mutex> lock2(mtx2, std::adopt_lock);
+        std::lock_guard<std::mutex> lock(mtx, std::adopt_lock);
+        nullOut << s << std::endl;
+    }
+};
+
+class Logger4 {
+    std::mutex mtx;
+    std::mutex mtx2;
+
+public:
+    void log(const std::string& s) {
+        std::lock(mtx, mtx2);
+        std::lock_guard<std::mutex> lock(mtx, std::adopt_lock);
+        std::lock_guard<std::mutex> lock2(mtx2, std::adopt_lock);
+        nullOut << s << std::endl;
+    }
+    // log2() unlocks mutexes it never locked (undefined behavior): not benchmarked
+};
+
+// From demo_007.cpp (without the sleeps and console output)
+struct SharedState {
+    std::shared_mutex sh_mutex;
+    long value = 0;
+
+    long read() {
+        std::shared_lock<std::shared_mutex> lock(sh_mutex);
+        return value;
+    }
+
+    void write(long v) {
+        std::unique_lock<std::shared_mutex> lock(sh_mutex);
+        value = v;
+    }
+};
+
+// ============================================================================
+// BENCHMARK REGISTRY
+// ============================================================================
+// One operation of a benchmark: called with (thread index, iteration)
+using Operation = std::function<void(unsigned, long)>;
+
+struct BenchmarkCase {
+    std::string name;
+    std::string description;
+    // Creates FRESH state for one repetition and returns the operation
+    std::function<Operation()> setup;
+};
+
+std::vector<BenchmarkCase> makeBenchmarks() {
+    std::vector<BenchmarkCase> cases;
+
+    cases.push_back({"dispMessage2", "global mutex_t + formatted output (demo_004)",
+        []() -> Operation {
+            return [](unsigned, long) { dispMessage2("T1 ---"); };
+        }});
+
+    cases.push_back({"SafeStack.push_pop", "push then tryPop (demo_005)",
+        []() -> Operation {
+            auto stack = std::make_shared<SafeStack>();
+            return [stack](unsigned, long i) {
+                int v;
+                stack->push(static_cast<int>(i));
+                stack->tryPop(v);
+            };
+        }});
+
+    cases.push_back({"SafeCounter.increment", "mutex counter (demo_005)",
+        []() -> Operation {
+            auto counter = std::make_shared<SafeCounter>();
+            return [counter](unsigned, long) { counter->increment(); };
+        }});
+
+    cases.push_back({"SafeLogger.log", "mutex + ofstream + std::endl to /dev/null (demo_005)",
+        []() -> Operation {
+            auto logger = std::make_shared<SafeLogger>("/dev/null");
+            return [logger](unsigned, long) { logger->log("benchmark message"); };
+        }});
+
+    cases.push_back({"Logger1.log", "two mutexes, fixed order, log() only (demo_006)",
+        []() -> Operation {
+            auto logger = std::make_shared<Logger1>();
+            return [logger](unsigned, long) { logger->log("T1 ---"); };
+        }});
+
+    cases.push_back({"Logger2.log_log2", "consistent ordering, log()/log2() alternating (demo_006)",
+        []() -> Operation {
+            auto logger = std::make_shared<Logger2>();
+            return [logger](unsigned, long i) {
+                if (i & 1) logger->log2("--- main"); else logger->log("T1 ---");
+            };
+        }});
+
+    cases.push_back({"Logger3.log_log2", "std::lock, log()/log2() alternating (demo_006)",
+        []() -> Operation {
+            auto logger = std::make_shared<Logger3>();
+            return [logger](unsigned, long i) {
+                if (i & 1) logger->log2("--- main"); else logger->log("T1 ---");
+            };
+        }});
+
+    cases.push_back({"Logger4.log", "std::lock + adopt_lock, log() only (demo_006)",
+        []() -> Operation {
+            auto logger = std::make_shared<Logger4>();
+            return [logger](unsigned, long) { logger->log("T1 ---"); };
+        }});
+
+    cases.push_back({"shared_mutex.read", "shared_lock readers only (demo_007)",
+        []() -> Operation {
+            auto state = std::make_shared<SharedState>();
+            return [state](unsigned, long) { state->read(); };
+        }});
+
+    cases.push_back({"shared_mutex.write", "unique_lock writers only (demo_007)",
+        []() -> Operation {
+            auto state = std::make_shared<SharedState>();
+            return [state](unsigned, long i) { state->write(i); };
+        }});
+
+    cases.push_back({"shared_mutex.mixed_95_5", "95% readers, 5% writers (demo_007)",
+        []() -> Operation {
+            auto state = std::make_shared<SharedState>();
+            return [state](unsigned, long i) {
+                if (i % 20 == 0) state->write(i);
+                else state->read();
+            };
+        }});
+
+    return cases;
+}
+
+// ============================================================================
+// RUNNER
+// ============================================================================
+struct Options {
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    long iterations = 100000;   // per thread, per repetition
+    long warmup = 10000;        // per thread, per repetition
+    int repetitions = 5;
+    std::string format = "text";
+    std::string filter;
+    bool list = false;
+};
+
+struct Result {
+    std::string name;
+    unsigned threads;
+    long iterations;
+    int repetitions;
+    double opsPerSec;          // median over repetitions
+    double p50, p99, p999, max; // nanoseconds, over all repetitions
+};
+
+// Value at quantile q of a SORTED vector
+double percentile(const std::vector<long>& sorted, double q) {
+    if (sorted.empty()) return 0;
+    std::size_t index = static_cast<std::size_t>(q * (sorted.size() - 1));
+    return static_cast<double>(sorted[index]);
+}
+
+Result runBenchmark(const BenchmarkCase& bench, const Options& opt) {
+    std::vector<double> throughputs;
+    std::vector<long> allLatencies;
+    allLatencies.reserve(static_cast<std::size_t>(opt.threads) * opt.iterations * opt.repetitions);
+
+    for (int rep = 0; rep < opt.repetitions; ++rep) {
+        Operation op = bench.setup();
+        std::vector<std::vector<long>> latencies(opt.threads);
+        std::atomic<unsigned> ready{0};
+        std::atomic<bool> go{false};
+        std::vector<std::thread> threads;
+
+        for (unsigned t = 0; t < opt.threads; ++t) {
+            threads.emplace_back([&, t]() {
+                // Warmup (untimed)
+                for (long i = 0; i < opt.warmup; ++i) {
+                    op(t, i);
+                }
+                std::vector<long>& lat = latencies[t];
+                lat.resize(opt.iterations);   // allocate BEFORE the timed phase
+
+                // Start barrier: every thread begins the timed phase together
+                ready.fetch_add(1);
+                while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+
+                for (long i = 0; i < opt.iterations; ++i) {
+                    auto begin = std::chrono::steady_clock::now();
+                    op(t, i);
+                    auto end = std::chrono::steady_clock::now();
+                    lat[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+                }
+            });
+        }
+
+        while (ready.load() < opt.threads) std::this_thread::yield();
+        auto start = std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto& th : threads) th.join();
+        auto stop = std::chrono::steady_clock::now();
+
+        double seconds = std::chrono::duration<double>(stop - start).count();
+        throughputs.push_back(opt.threads * opt.iterations / seconds);
+        for (auto& lat : latencies) {
+            allLatencies.insert(allLatencies.end(), lat.begin(), lat.end());
+        }
+    }
+
+    std::sort(throughputs.begin(), throughputs.end());
+    std::sort(allLatencies.begin(), allLatencies.end());
+
+    Result r;
+    r.name = bench.name;
+    r.threads = opt.threads;
+    r.iterations = opt.iterations;
+    r.repetitions = opt.repetitions;
+    r.opsPerSec = throughputs[throughputs.size() / 2];
+    r.p50 = percentile(allLatencies, 0.50);
+    r.p99 = percentile(allLatencies, 0.99);
+    r.p999 = percentile(allLatencies, 0.999);
+    r.max = allLatencies.empty() ? 0 : static_cast<double>(allLatencies.back());
+    return r;
+}
+
+// ============================================================================
+// OUTPUT
+// ============================================================================
+void printText(const std::vector<Result>& results) {
+    std::cout << "benchmark                 threads  ops/sec        p50(ns)  p99(ns)  p999(ns) max(ns)" << std::endl;
+    for (const auto& r : results) {
+        std::ostringstream line;
+        line.width(26); line << std::left << r.name;
+        line.width(9);  line << r.threads;
+        line.width(15); line << static_cast<long>(r.opsPerSec);
+        line.width(9);  line << static_cast<long>(r.p50);
+        line.width(9);  line << static_cast<long>(r.p99);
+        line.width(9);  line << static_cast<long>(r.p999);
+        line << static_cast<long>(r.max);
+        std::cout << line.str() << std::endl;
+    }
+}
+
+void printCsv(const std::vector<Result>& results) {
+    std::cout << "name,threads,iterations,repetitions,ops_per_sec,p50_ns,p99_ns,p999_ns,max_ns" << std::endl;
+    for (const auto& r : results) {
+        std::cout << r.name << "," << r.threads << "," << r.iterations << ","
+                  << r.repetitions << "," << static_cast<long>(r.opsPerSec) << ","
+                  << static_cast<long>(r.p50) << "," << static_cast<long>(r.p99) << ","
+                  << static_cast<long>(r.p999) << "," << static_cast<long>(r.max) << std::endl;
+    }
+}
+
+void printJson(const std::vector<Result>& results) {
+    std::cout << "[" << std::endl;
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::cout << "  {\"name\": \"" << r.name << "\", \"threads\": " << r.threads
+                  << ", \"iterations\": " << r.iterations
+                  << ", \"repetitions\": " << r.repetitions
+                  << ", \"ops_per_sec\": " << static_cast<long>(r.opsPerSec)
+                  << ", \"p50_ns\": " << static_cast<long>(r.p50)
+                  << ", \"p99_ns\": " << static_cast<long>(r.p99)
+                  << ", \"p999_ns\": " << static_cast<long>(r.p999)
+                  << ", \"max_ns\": " << static_cast<long>(r.max) << "}"
+                  << (i + 1 < results.size() ? "," : "") << std::endl;
+    }
+    std::cout << "]" << std::endl;
+}
+
+// ============================================================================
+// COMMAND LINE
+// ============================================================================
+Options parseOptions(int argc, char* argv[]) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::runtime_error("missing value for " + arg);
+            return argv[++i];
+        };
+        if (arg == "--threads") opt.threads = static_cast<unsigned>(std::stoul(next()));
+        else if (arg == "--iters") opt.iterations = std::stol(next());
+        else if (arg == "--warmup") opt.warmup = std::stol(next());
+        else if (arg == "--reps") opt.repetitions = std::stoi(next());
+        else if (arg == "--format") opt.format = next();
+        else if (arg == "--filter") opt.filter = next();
+        else if (arg == "--list") opt.list = true;
+        else throw std::runtime_error("unknown option " + arg);
+    }
+    if (opt.threads == 0 || opt.iterations <= 0 || opt.warmup < 0 || opt.repetitions <= 0) {
+        throw std::runtime_error("threads, iters and reps must be positive");
+    }
+    if (opt.format != "text" && opt.format != "json" && opt.format != "csv") {
+        throw std::runtime_error("format must be text, json or csv");
+    }
+    return opt;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main(int argc, char* argv[]) {
+    Options opt;
+    try {
+        opt = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        std::cerr << "usage: " << argv[0] << " [--threads N] [--iters N] [--warmup N] [--reps N]"
+                  << " [--format text|json|csv] [--filter SUBSTRING] [--list]" << std::endl;
+        return 1;
+    }
+
+    std::vector<BenchmarkCase> cases = makeBenchmarks();
+
+    if (opt.list) {
+        for (const auto& c : cases) {
+            std::cout << c.name << " - " << c.description << std::endl;
+        }
+        return 0;
+    }
+
+    // Diagnostics go to stderr so that json/csv on stdout stay machine-readable
+    std::vector<Result> results;
+    for (const auto& c : cases) {
+        if (!opt.filter.empty() && c.name.find(opt.filter) == std::string::npos) continue;
+        std::cerr << "running " << c.name << " ..." << std::endl;
+        results.push_back(runBenchmark(c, opt));
+    }
+
+    if (opt.format == "json") printJson(results);
+    else if (opt.format == "csv") printCsv(results);
+    else printText(results);
+
+    return 0;
+}
+
+// ============================================================================
+// READING THE RESULTS
+// ============================================================================
+/*
+1. TIMER OVERHEAD
+   - Every operation is wrapped in two steady_clock::now() calls (~20-50ns)
+   - ops/sec therefore includes that overhead; compare primitives against
+     each other, not against numbers from other tools
+
+2. THREADS vs CORES
+   - With more threads than cores, threads are preempted while holding a
+     lock: p999 and max explode (lock convoys) - this is real behavior
+
+3. NOISE
+   - Close other programs, repeat runs, look at the MEDIAN (what is printed)
+   - Differences below ~5% are usually noise
+*/
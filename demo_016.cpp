@@ -0,0 +1,456 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+
+// ============================================================================
+// LESSON: FINDING THE BOTTLENECK LOCK (INSTRUMENTED MUTEX)
+// ============================================================================
+/*
+THE QUESTION:
+- demo_004 has a global 'mtx' and a 'Logger::mtx'; demo_005 has
+  'SafeLogger::mtx'. When the program is slow, WHICH lock is the problem?
+- A profiler shows time "in pthread_mutex_lock" - but not for which mutex
+
+THE SOLUTION: A PROFILING MUTEX
+- Same interface as std::mutex (lock / unlock / try_lock), so it works with
+  std::lock_guard, std::unique_lock and std::lock
+- Records, PER LOCK INSTANCE:
+    acquisitions            how often it was locked
+    contended acquisitions  how often a thread had to WAIT
+    total / max wait time   how long threads waited
+    hold-time histogram     how long the lock was held
+- Switched on with ONE line - the mutex_t alias from demo_004.cpp:
+    typedef ProfiledMutex mutex_t;   // profiling
+    typedef std::mutex    mutex_t;   // production
+  This file uses ProfiledMutex unless compiled with -DNO_LOCK_PROFILING
+
+LOW OVERHEAD DESIGN:
+- Uncontended path: try_lock() + two clock reads + a few relaxed adds
+- Statistics are SHARDED per thread (like demo_008's ShardedCounter):
+  each thread adds to its own cache line, no global lock, no false sharing
+- The global registry lock is only taken when a mutex is created,
+  destroyed or reported - never on lock()/unlock()
+*/
+
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+// ============================================================================
+// LOCK STATISTICS
+// ============================================================================
+// Hold times go into power-of-two buckets: bucket i = [2^i, 2^(i+1)) ns
+constexpr int HOLD_BUCKETS = 40;
+
+// A plain (non-atomic) copy of the statistics, used for reporting
+struct LockStats {
+    std::string name;
+    std::uint64_t id = 0;                 // per-instance: tells same-named locks apart
+    std::uint64_t acquisitions = 0;
+    std::uint64_t contended = 0;
+    std::uint64_t totalWaitNs = 0;
+    std::uint64_t maxWaitNs = 0;
+    std::uint64_t totalHoldNs = 0;
+    std::uint64_t holdHistogram[HOLD_BUCKETS] = {};
+
+    // Upper bound of the bucket containing quantile q
+    std::uint64_t holdPercentileNs(double q) const {
+        std::uint64_t target = static_cast<std::uint64_t>(q * acquisitions);
+        std::uint64_t seen = 0;
+        for (int i = 0; i < HOLD_BUCKETS; ++i) {
+            seen += holdHistogram[i];
+            if (seen > target) return std::uint64_t(1) << (i + 1);
+        }
+        return 0;
+    }
+};
+
+class ProfiledMutex;
+
+// Knows every live ProfiledMutex and keeps the statistics of destroyed ones
+// Prints a report when the program exits
+class LockRegistry {
+private:
+    std::mutex mtx;
+    std::vector<ProfiledMutex*> live;
+    std::vector<LockStats> retired;
+
+public:
+    bool reportAtExit = true;
+
+    static LockRegistry& instance() {
+        static LockRegistry registry;
+        return registry;
+    }
+
+    ~LockRegistry();
+
+    void add(ProfiledMutex* m) {
+        std::lock_guard<std::mutex> lock(mtx);
+        live.push_back(m);
+    }
+
+    void remove(ProfiledMutex* m);
+    void rename(ProfiledMutex* m, const std::string& name);
+    void report(std::ostream& out);
+};
+
+// ============================================================================
+// PROFILED MUTEX
+// ============================================================================
+class ProfiledMutex {
+private:
+    // Per-thread statistics shard, on its own cache line
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        std::atomic<std::uint64_t> acquisitions{0};
+        std::atomic<std::uint64_t> contended{0};
+        std::atomic<std::uint64_t> totalWaitNs{0};
+        std::atomic<std::uint64_t> maxWaitNs{0};
+        std::atomic<std::uint64_t> totalHoldNs{0};
+        std::atomic<std::uint64_t> holdHistogram[HOLD_BUCKETS];
+
+        Shard() {
+            for (auto& b : holdHistogram) b.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    friend class LockRegistry;
+
+    std::mutex m;
+    std::string name;              // guarded by the registry mutex: read by report()
+    const std::uint64_t id;        // unique per instance, for the report
+    std::unique_ptr<Shard[]> shards;
+    std::size_t shardMask;
+
+    // Written only by the current owner, so it needs no synchronization
+    std::chrono::steady_clock::time_point holdStart;
+
+    static std::size_t threadIndex() {
+        static std::atomic<std::size_t> nextIndex{0};
+        thread_local const std::size_t index = nextIndex.fetch_add(1);
+        return index;
+    }
+
+    Shard& myShard() { return shards[threadIndex() & shardMask]; }
+
+    static std::uint64_t nextId() {
+        static std::atomic<std::uint64_t> counter{0};
+        return ++counter;
+    }
+
+    static std::uint64_t nanosSince(std::chrono::steady_clock::time_point t) {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - t).count());
+    }
+
+    static int bucketOf(std::uint64_t ns) {
+        int b = 0;
+        while (ns > 1 && b < HOLD_BUCKETS - 1) {
+            ns >>= 1;
+            ++b;
+        }
+        return b;
+    }
+
+    // Called right after the mutex was acquired
+    void acquired(std::uint64_t waitNs, bool wasContended) {
+        Shard& s = myShard();
+        s.acquisitions.fetch_add(1, std::memory_order_relaxed);
+        if (wasContended) {
+            s.contended.fetch_add(1, std::memory_order_relaxed);
+            s.totalWaitNs.fetch_add(waitNs, std::memory_order_relaxed);
+            // Several threads share a shard once threads outnumber shards:
+            // a plain load + store could overwrite a larger maximum
+            std::uint64_t seen = s.maxWaitNs.load(std::memory_order_relaxed);
+            while (waitNs > seen && !s.maxWaitNs.compare_exchange_weak(seen, waitNs, std::memory_order_relaxed)) {
+            }
+        }
+        holdStart = std::chrono::steady_clock::now();
+    }
+
+public:
+    explicit ProfiledMutex(std::string lockName = "unnamed")
+        : name(std::move(lockName)), id(nextId()), shards(nullptr), shardMask(0) {
+        std::size_t n = 1;
+        while (n < std::max(1u, std::thread::hardware_concurrency())) n <<= 1;
+        shards.reset(new Shard[n]);
+        shardMask = n - 1;
+        LockRegistry::instance().add(this);
+    }
+
+    ~ProfiledMutex() {
+        LockRegistry::instance().remove(this);
+    }
+
+    ProfiledMutex(const ProfiledMutex&) = delete;
+    ProfiledMutex& operator=(const ProfiledMutex&) = delete;
+
+    // --- std::mutex interface (the "Lockable" requirements) ---
+    void lock() {
+        if (m.try_lock()) {
+            acquired(0, false);   // fast path: nobody was holding it
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        m.lock();
+        acquired(nanosSince(start), true);
+    }
+
+    bool try_lock() {
+        if (!m.try_lock()) return false;
+        acquired(0, false);
+        return true;
+    }
+
+    void unlock() {
+        std::uint64_t held = nanosSince(holdStart);
+        Shard& s = myShard();
+        s.totalHoldNs.fetch_add(held, std::memory_order_relaxed);
+        s.holdHistogram[bucketOf(held)].fetch_add(1, std::memory_order_relaxed);
+        m.unlock();
+    }
+
+    // --- profiling interface ---
+    // Renaming is rare: it goes through the registry lock, like report()
+    void setName(const std::string& lockName) { LockRegistry::instance().rename(this, lockName); }
+
+    // Merge all shards into one plain snapshot (the name is filled in by
+    // the registry, under its lock)
+    LockStats snapshot() const {
+        LockStats out;
+        for (std::size_t i = 0; i <= shardMask; ++i) {
+            const Shard& s = shards[i];
+            out.acquisitions += s.acquisitions.load(std::memory_order_relaxed);
+            out.contended += s.contended.load(std::memory_order_relaxed);
+            out.totalWaitNs += s.totalWaitNs.load(std::memory_order_relaxed);
+            out.maxWaitNs = std::max<std::uint64_t>(out.maxWaitNs, s.maxWaitNs.load(std::memory_order_relaxed));
+            out.totalHoldNs += s.totalHoldNs.load(std::memory_order_relaxed);
+            for (int b = 0; b < HOLD_BUCKETS; ++b)
+                out.holdHistogram[b] += s.holdHistogram[b].load(std::memory_order_relaxed);
+        }
+        return out;
+    }
+};
+
+// --- LockRegistry members that need the full ProfiledMutex definition ---
+
+void LockRegistry::remove(ProfiledMutex* m) {
+    LockStats last = m->snapshot();
+    std::lock_guard<std::mutex> lock(mtx);
+    last.name = m->name;
+    last.id = m->id;
+    live.erase(std::remove(live.begin(), live.end(), m), live.end());
+    // Keep the numbers of THIS instance; same-named locks are not folded together
+    retired.push_back(last);
+}
+
+void LockRegistry::rename(ProfiledMutex* m, const std::string& name) {
+    std::lock_guard<std::mutex> lock(mtx);
+    m->name = name;
+}
+
+void LockRegistry::report(std::ostream& out) {
+    std::vector<LockStats> all;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (ProfiledMutex* m : live) {
+            all.push_back(m->snapshot());
+            all.back().name = m->name;
+            all.back().id = m->id;
+        }
+        all.insert(all.end(), retired.begin(), retired.end());
+    }
+    // Worst offenders first: most total wait time
+    std::sort(all.begin(), all.end(), [](const LockStats& a, const LockStats& b) {
+        return a.totalWaitNs > b.totalWaitNs;
+    });
+
+    out << "\n--- LOCK PROFILE (sorted by total wait) ---" << std::endl;
+    out << "lock                    acquired   contended  wait-total(us) wait-max(us) hold-avg(ns) hold-p99(ns)" << std::endl;
+    for (const auto& s : all) {
+        if (s.acquisitions == 0) continue;
+        std::ostringstream line;
+        std::string label = s.name;
+        if (std::count_if(all.begin(), all.end(), [&s](const LockStats& o) { return o.name == s.name; }) > 1) {
+            label += " #" + std::to_string(s.id);   // several locks share this name
+        }
+        line.width(24); line << std::left << label;
+        line.width(11); line << s.acquisitions;
+        std::ostringstream pct;
+        pct << s.contended << " (" << (100 * s.contended / s.acquisitions) << "%)";
+        line.width(11); line << pct.str();
+        line.width(15); line << s.totalWaitNs / 1000;
+        line.width(13); line << s.maxWaitNs / 1000;
+        line.width(13); line << s.totalHoldNs / s.acquisitions;
+        line << s.holdPercentileNs(0.99);
+        out << line.str() << std::endl;
+    }
+}
+
+LockRegistry::~LockRegistry() {
+    if (reportAtExit) report(std::cerr);
+}
+
+// ============================================================================
+// THE SWITCH: mutex_t (as in demo_004.cpp)
+// ============================================================================
+#ifdef NO_LOCK_PROFILING
+typedef std::mutex mutex_t;
+inline void nameLock(mutex_t&, const std::string&) {}              // no-op
+#else
+typedef ProfiledMutex mutex_t;
+inline void nameLock(mutex_t& m, const std::string& n) { m.setName(n); }
+#endif
+
+// ============================================================================
+// CODE UNDER INVESTIGATION (from demo_004.cpp and demo_005.cpp)
+// ============================================================================
+// The only change: std::mutex -> mutex_t, plus a name for the report
+
+// From demo_004.cpp: global mutex protecting std::cout
+mutex_t mtx;
+
+void dispMessage2(const std::string& s) {
+    std::lock_guard<mutex_t> lock(mtx);
+    std::cout << s << "\n";
+}
+
+// From demo_004.cpp: Logger binds a mutex to a file
+class Logger {
+    mutex_t mtx;
+    std::ofstream f;
+
+public:
+    Logger() {
+        nameLock(mtx, "Logger::mtx");
+        f.open("app.log");
+    }
+
+    void log(const std::string& s) {
+        std::lock_guard<mutex_t> lock(mtx);
+        f << s << std::endl;
+    }
+};
+
+// From demo_005.cpp
+class SafeLogger {
+private:
+    mutable mutex_t mtx;
+    std::ofstream logFile;
+
+public:
+    SafeLogger(const std::string& filename) {
+        nameLock(mtx, "SafeLogger::mtx");
+        logFile.open(filename, std::ios::app);
+        if (!logFile.is_open()) {
+            throw std::runtime_error("Failed to open log file");
+        }
+    }
+
+    SafeLogger(const SafeLogger&) = delete;
+    SafeLogger& operator=(const SafeLogger&) = delete;
+
+    void log(const std::string& message) {
+        std::lock_guard<mutex_t> lock(mtx);
+        logFile << "[" << std::this_thread::get_id() << "] "
+                << message << std::endl;
+    }
+};
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: Run all three locks under load, then ask the profiler
+void demo1_find_the_bottleneck() {
+    std::cout << "\n=== DEMO 1: Which Lock Is the Bottleneck? ===" << std::endl;
+    nameLock(mtx, "demo_004 global mtx");
+
+    Logger logger;
+    SafeLogger safeLogger("app.log");
+
+    auto worker = [&logger, &safeLogger](int id) {
+        for (int i = 0; i < 2000; ++i) {
+            if (i % 100 == 0) dispMessage2("T" + std::to_string(id) + " ---");
+            logger.log("T" + std::to_string(id) + " ---");
+            safeLogger.log("Message " + std::to_string(i));
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) threads.emplace_back(worker, t);
+    for (auto& t : threads) t.join();
+
+#ifndef NO_LOCK_PROFILING
+    // On-demand report (another one is printed automatically at exit)
+    LockRegistry::instance().report(std::cout);
+#endif
+}
+
+// Demo 2: Cost of the instrumentation on an uncontended lock
+void demo2_overhead() {
+    std::cout << "\n=== DEMO 2: Instrumentation Overhead (uncontended) ===" << std::endl;
+
+    const int iterations = 1000000;
+    std::mutex plain;
+    ProfiledMutex profiled("overhead-test");
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        std::lock_guard<std::mutex> lock(plain);
+    }
+    auto mid = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        std::lock_guard<ProfiledMutex> lock(profiled);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double plainNs = std::chrono::duration<double, std::nano>(mid - start).count() / iterations;
+    double profiledNs = std::chrono::duration<double, std::nano>(end - mid).count() / iterations;
+    std::cout << "std::mutex lock+unlock:    " << plainNs << " ns" << std::endl;
+    std::cout << "ProfiledMutex lock+unlock: " << profiledNs << " ns" << std::endl;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== LOCK PROFILING DEMONSTRATIONS ===" << std::endl;
+#ifdef NO_LOCK_PROFILING
+    std::cout << "mutex_t = std::mutex (profiling disabled)" << std::endl;
+#else
+    std::cout << "mutex_t = ProfiledMutex (build with -DNO_LOCK_PROFILING to disable)" << std::endl;
+#endif
+
+    demo1_find_the_bottleneck();
+    demo2_overhead();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+    std::cout << "(final lock profile follows on stderr)" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// HOW TO READ THE REPORT
+// ============================================================================
+/*
+HIGH contended % AND HIGH wait-total:
+- This lock IS the bottleneck -> shorten the critical section, shard the
+  data (demo_008), or move work out of the lock (demo_012)
+
+LOW contended % BUT HIGH hold-avg:
+- Nobody waits (yet), but the lock is held for a long time -> it will
+  become the bottleneck as soon as more threads use it
+
+HIGH wait-max, LOW wait-total:
+- Rare long stalls: usually preemption of the lock holder or I/O inside
+  the critical section (SafeLogger's std::endl is a classic)
+*/
@@ -0,0 +1,399 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <array>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+// ============================================================================
+// LESSON: ORDERED MULTI-LOCK (NO RETRIES)
+// ============================================================================
+/*
+HOW std::lock(mtx, mtx2) WORKS (libstdc++):
+- lock the first mutex, then try_lock() the others
+- if a try_lock() fails: UNLOCK everything, yield, and start again
+  (beginning with the mutex that failed)
+- Deadlock-free, but under heavy contention threads keep locking and
+  unlocking without making progress: a "retry storm"
+- std::scoped_lock(mtx, mtx2) uses the same algorithm
+
+THE ALTERNATIVE: A GLOBAL LOCK ORDER
+- Logger2 in demo_006.cpp avoids deadlock by always locking mtx before mtx2
+- multi_lock() does the same AUTOMATICALLY for any set of mutexes:
+    1. sort the mutexes by a global key (an assigned rank, then the address)
+    2. lock them one after another with plain blocking lock()
+- Every thread uses the same order -> no circular wait -> no deadlock
+- No try_lock(), no back-off, no retries: a waiting thread sleeps in lock()
+
+    thread A: log()  -> multi_lock(mtx, mtx2) -> locks 0x1000, then 0x1040
+    thread B: log2() -> multi_lock(mtx2, mtx) -> locks 0x1000, then 0x1040
+*/
+
+// ============================================================================
+// RANKED MUTEX: An Explicit Position in the Global Lock Order
+// ============================================================================
+// Plain mutexes are ordered by address. A RankedMutex is ordered by its rank
+// first, which documents the intended order and is stable across runs.
+template <typename Mutex = std::mutex>
+class RankedMutex {
+private:
+    Mutex m;
+    const unsigned rank;
+
+public:
+    explicit RankedMutex(unsigned r) : rank(r) {}
+
+    void lock() { m.lock(); }
+    bool try_lock() { return m.try_lock(); }
+    void unlock() { m.unlock(); }
+
+    unsigned getRank() const { return rank; }
+};
+
+// The rank of any lockable: 0 for plain mutexes
+template <typename Mutex>
+unsigned lockRank(const Mutex&) { return 0; }
+
+template <typename Mutex>
+unsigned lockRank(const RankedMutex<Mutex>& m) { return m.getRank(); }
+
+// ============================================================================
+// GOOD EXAMPLE: multi_lock / multi_unlock / MultiLockGuard
+// ============================================================================
+namespace detail {
+
+// One entry per mutex: its sort key plus type-erased lock/unlock
+struct LockEntry {
+    unsigned rank;
+    std::uintptr_t address;
+    void* mutex;
+    void (*lockFn)(void*);
+    void (*unlockFn)(void*);
+
+    bool before(const LockEntry& other) const {
+        if (rank != other.rank) return rank < other.rank;
+        return address < other.address;
+    }
+};
+
+template <typename Mutex>
+LockEntry makeEntry(Mutex& m) {
+    return LockEntry{lockRank(m), reinterpret_cast<std::uintptr_t>(&m), &m,
+                     [](void* p) { static_cast<Mutex*>(p)->lock(); },
+                     [](void* p) { static_cast<Mutex*>(p)->unlock(); }};
+}
+
+// Entries in global lock order (insertion sort: N is tiny)
+template <std::size_t N>
+class OrderedLockSet {
+private:
+    std::array<LockEntry, N> entries;
+
+public:
+    template <typename... Mutexes>
+    explicit OrderedLockSet(Mutexes&... ms) : entries{{makeEntry(ms)...}} {
+        for (std::size_t i = 1; i < N; ++i) {
+            LockEntry e = entries[i];
+            std::size_t j = i;
+            while (j > 0 && e.before(entries[j - 1])) {
+                entries[j] = entries[j - 1];
+                --j;
+            }
+            entries[j] = e;
+        }
+    }
+
+    void lockAll() const {
+        for (std::size_t i = 0; i < N; ++i) {
+            // The same mutex passed twice is locked once (no self-deadlock)
+            if (i > 0 && entries[i].mutex == entries[i - 1].mutex) continue;
+            entries[i].lockFn(entries[i].mutex);
+        }
+    }
+
+    // Reverse order: the usual convention, and the cheapest for waiters
+    void unlockAll() const {
+        for (std::size_t i = N; i-- > 0;) {
+            if (i > 0 && entries[i].mutex == entries[i - 1].mutex) continue;
+            entries[i].unlockFn(entries[i].mutex);
+        }
+    }
+};
+
+} // namespace detail
+
+// Lock any number of mutexes in the global order - like std::lock, no retries
+template <typename... Mutexes>
+void multi_lock(Mutexes&... ms) {
+    detail::OrderedLockSet<sizeof...(Mutexes)>(ms...).lockAll();
+}
+
+// Unlock mutexes previously locked with multi_lock (any argument order)
+template <typename... Mutexes>
+void multi_unlock(Mutexes&... ms) {
+    detail::OrderedLockSet<sizeof...(Mutexes)>(ms...).unlockAll();
+}
+
+// RAII guard - like std::scoped_lock, but ordered instead of retrying
+template <typename... Mutexes>
+class MultiLockGuard {
+private:
+    detail::OrderedLockSet<sizeof...(Mutexes)> set;
+
+public:
+    explicit MultiLockGuard(Mutexes&... ms) : set(ms...) {
+        set.lockAll();
+    }
+
+    ~MultiLockGuard() {
+        set.unlockAll();
+    }
+
+    MultiLockGuard(const MultiLockGuard&) = delete;
+    MultiLockGuard& operator=(const MultiLockGuard&) = delete;
+};
+
+// ============================================================================
+// INSTRUMENTATION: Counting Lock Operations
+// ============================================================================
+// Wraps std::mutex and counts every lock()/try_lock() call
+// Shows how much extra locking the retry algorithm does
+std::atomic<long> lockOps{0};
+
+class CountingMutex {
+private:
+    std::mutex m;
+
+public:
+    void lock() {
+        lockOps.fetch_add(1, std::memory_order_relaxed);
+        m.lock();
+    }
+
+    bool try_lock() {
+        lockOps.fetch_add(1, std::memory_order_relaxed);
+        return m.try_lock();
+    }
+
+    void unlock() { m.unlock(); }
+};
+
+// ============================================================================
+// Logger3 (demo_006.cpp) WITH THREE LOCKING STRATEGIES
+// ============================================================================
+// Output goes to a string instead of std::cout so the benchmark
+// measures locking, not the terminal
+
+// Original: std::lock + adopt_lock
+template <typename Mutex>
+class Logger3StdLock {
+    Mutex mtx;
+    Mutex mtx2;
+    std::string out;
+
+public:
+    void log(const std::string& s) {
+        std::lock(mtx, mtx2);
+        std::lock_guard<Mutex> lock(mtx, std::adopt_lock);
+        std::lock_guard<Mutex> lock2(mtx2, std::adopt_lock);
+        out.assign(s);
+    }
+
+    void log2(const std::string& s) {
+        std::lock(mtx2, mtx);   // opposite argument order, as a caller might write it
+        std::lock_guard<Mutex> lock2(mtx2, std::adopt_lock);
+        std::lock_guard<Mutex> lock(mtx, std::adopt_lock);
+        out.assign(s);
+    }
+};
+
+// C++17: std::scoped_lock (same algorithm as std::lock)
+template <typename Mutex>
+class Logger3ScopedLock {
+    Mutex mtx;
+    Mutex mtx2;
+    std::string out;
+
+public:
+    void log(const std::string& s) {
+        std::scoped_lock lock(mtx, mtx2);
+        out.assign(s);
+    }
+
+    void log2(const std::string& s) {
+        std::scoped_lock lock(mtx2, mtx);
+        out.assign(s);
+    }
+};
+
+// New: MultiLockGuard (ordered, no retries)
+template <typename Mutex>
+class Logger3MultiLock {
+    Mutex mtx;
+    Mutex mtx2;
+    std::string out;
+
+public:
+    void log(const std::string& s) {
+        MultiLockGuard<Mutex, Mutex> lock(mtx, mtx2);
+        out.assign(s);
+    }
+
+    void log2(const std::string& s) {
+        MultiLockGuard<Mutex, Mutex> lock(mtx2, mtx);   // order of arguments does not matter
+        out.assign(s);
+    }
+};
+
+// numThreads threads call log()/log2() alternately
+// Returns calls per second
+template <typename Logger>
+double measureLogger(unsigned numThreads, int callsPerThread) {
+    Logger logger;
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&logger, callsPerThread]() {
+            for (int i = 0; i < callsPerThread; ++i) {
+                if (i & 1) logger.log2("--- main");
+                else logger.log("T1 ---");
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    auto end = std::chrono::steady_clock::now();
+    return numThreads * callsPerThread / std::chrono::duration<double>(end - start).count();
+}
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: multi_lock / MultiLockGuard basics
+void demo1_basics() {
+    std::cout << "\n=== DEMO 1: multi_lock and MultiLockGuard ===" << std::endl;
+
+    std::mutex a, b, c;
+
+    // Free functions: any number of mutexes, any argument order
+    multi_lock(c, a, b);
+    std::cout << "Locked c, a, b (in address order)" << std::endl;
+    multi_unlock(a, b, c);
+
+    // RAII: unlocked when the guard goes out of scope
+    {
+        MultiLockGuard<std::mutex, std::mutex> guard(b, a);
+        std::cout << "Guard holds a and b" << std::endl;
+    }
+    std::cout << "a free again: " << (a.try_lock() ? "yes" : "no") << std::endl;
+    a.unlock();
+
+    // Ranked mutexes: the rank decides the order, not the address
+    RankedMutex<> accounts(1), audit(2);
+    {
+        MultiLockGuard<RankedMutex<>, RankedMutex<>> guard(audit, accounts);
+        std::cout << "Locked rank 1 (accounts) before rank 2 (audit)" << std::endl;
+    }
+
+    // Passing the same mutex twice does not self-deadlock
+    {
+        MultiLockGuard<std::mutex, std::mutex> guard(a, a);
+        std::cout << "Same mutex twice: locked once" << std::endl;
+    }
+}
+
+// Demo 2: Logger3 - no deadlock with opposite lock orders
+void demo2_no_deadlock() {
+    std::cout << "\n=== DEMO 2: log() and log2() with Opposite Orders ===" << std::endl;
+
+    Logger3MultiLock<std::mutex> logger;
+    std::thread t1([&logger]() {
+        for (int i = 0; i < 100000; ++i) logger.log("T1 ---");
+    });
+    for (int i = 0; i < 100000; ++i) logger.log2("--- main");
+    t1.join();
+
+    std::cout << "200000 calls finished without deadlock" << std::endl;
+}
+
+// Demo 3: Throughput and lock operations per call
+void demo3_benchmark() {
+    std::cout << "\n=== DEMO 3: Benchmark (log()/log2() alternating) ===" << std::endl;
+
+    const int callsPerThread = 200000;
+
+    std::cout << "calls/sec:" << std::endl;
+    std::cout << "threads\tstd::lock\tscoped_lock\tMultiLockGuard" << std::endl;
+    for (unsigned n = 2; n <= 8; n *= 2) {
+        double stdLock = measureLogger<Logger3StdLock<std::mutex>>(n, callsPerThread);
+        double scoped = measureLogger<Logger3ScopedLock<std::mutex>>(n, callsPerThread);
+        double multi = measureLogger<Logger3MultiLock<std::mutex>>(n, callsPerThread);
+        std::cout << n << "\t" << static_cast<long>(stdLock) << "\t\t"
+                  << static_cast<long>(scoped) << "\t\t"
+                  << static_cast<long>(multi) << std::endl;
+    }
+
+    // With two mutexes the minimum is 2 lock operations per call;
+    // everything above that is retries
+    std::cout << "\nlock()/try_lock() calls per log call (minimum 2):" << std::endl;
+    std::cout << "threads\tstd::lock\tscoped_lock\tMultiLockGuard" << std::endl;
+    for (unsigned n = 2; n <= 8; n *= 2) {
+        double total = static_cast<double>(n) * callsPerThread;
+        std::function<void()> runs[] = {
+            [n, callsPerThread]() { measureLogger<Logger3StdLock<CountingMutex>>(n, callsPerThread); },
+            [n, callsPerThread]() { measureLogger<Logger3ScopedLock<CountingMutex>>(n, callsPerThread); },
+            [n, callsPerThread]() { measureLogger<Logger3MultiLock<CountingMutex>>(n, callsPerThread); },
+        };
+        std::cout << n;
+        for (auto& run : runs) {
+            lockOps.store(0);
+            run();
+            std::cout << "\t" << lockOps.load() / total << "\t";
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << "Note: retries only appear when threads really run in parallel" << std::endl;
+    std::cout << "(hardware threads here: " << std::thread::hardware_concurrency() << ")" << std::endl;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== ORDERED MULTI-LOCK DEMONSTRATIONS ===" << std::endl;
+
+    demo1_basics();
+    demo2_no_deadlock();
+    demo3_benchmark();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// WHEN TO USE WHICH
+// ============================================================================
+/*
+std::lock / std::scoped_lock:
+- Works for ANY set of mutexes, even ones whose order is unknown
+- Fine at low contention; can waste work retrying at high contention
+
+multi_lock / MultiLockGuard:
+- Deadlock-free only if EVERY multi-mutex acquisition in the program uses
+  the same order - mixing it with hand-written lock sequences in a
+  different order can still deadlock
+- Never retries: a waiting thread simply blocks in lock()
+- Ranks make the order explicit (e.g. "accounts before audit") and
+  independent of where the mutexes happen to be in memory
+
+Ordering by address is stable only while the objects do not move:
+mutexes are neither copyable nor movable, so this always holds.
+*/
@@ -0,0 +1,338 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// ============================================================================
+// LESSON: SEQLOCK (READERS THAT NEVER WRITE SHARED MEMORY)
+// ============================================================================
+/*
+THE HIDDEN COST OF shared_lock (demo_007.cpp):
+- shared_lock<shared_mutex> lets many readers in at the same time
+- BUT every lock_shared() / unlock_shared() is an atomic read-modify-write
+  on the reader count inside the mutex
+- All readers write to the SAME cache line -> it bounces between cores
+- With many reader threads the readers mostly wait for that cache line
+
+THE SOLUTION FOR SMALL DATA: A SEQLOCK
+- A sequence number next to the data:
+    even = stable, odd = a writer is in the middle of an update
+- WRITER: seq++ (now odd) -> write data -> seq++ (even again)
+- READER: read seq -> copy data -> read seq again
+          same even number both times? -> the copy is consistent
+          otherwise -> a writer interfered, RETRY
+- Readers only READ shared memory: the cache line stays shared by all cores
+
+REQUIREMENTS:
+- T must be trivially copyable: a reader may copy a half-written value
+  (and then throw it away), which is only harmless for plain data
+- T should be small: every retry copies it again
+- Writes should be rare: frequent writes make readers retry forever
+*/
+
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+// ============================================================================
+// GOOD EXAMPLE: SeqLocked<T>
+// ============================================================================
+template <typename T>
+class SeqLocked {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SeqLocked<T> requires a trivially copyable T");
+
+private:
+    // The value is stored as atomic words: a reader racing with a writer is
+    // then well-defined C++ (a plain struct copy would be a data race)
+    static constexpr std::size_t WORDS = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    alignas(CACHE_LINE_SIZE) std::atomic<std::uint64_t> seq;
+    std::atomic<std::uint64_t> words[WORDS];
+    std::mutex writeMtx;   // writers are serialized; readers never touch it
+
+    void storeWords(const T& value) {
+        std::uint64_t buffer[WORDS] = {};
+        std::memcpy(buffer, &value, sizeof(T));
+        for (std::size_t i = 0; i < WORDS; ++i) {
+            words[i].store(buffer[i], std::memory_order_relaxed);
+        }
+    }
+
+    // Caller holds writeMtx
+    void publish(const T& value) {
+        std::uint64_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        // Keep the data stores below from moving above the odd sequence
+        std::atomic_thread_fence(std::memory_order_release);
+        storeWords(value);
+        seq.store(s + 2, std::memory_order_release);
+    }
+
+public:
+    explicit SeqLocked(const T& initial = T()) : seq(0) {
+        storeWords(initial);
+    }
+
+    SeqLocked(const SeqLocked&) = delete;
+    SeqLocked& operator=(const SeqLocked&) = delete;
+
+    // Reader: never writes shared memory, retries on a version mismatch
+    T load() const {
+        std::uint64_t buffer[WORDS];
+        for (;;) {
+            std::uint64_t before = seq.load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield();   // writer in progress
+                continue;
+            }
+            for (std::size_t i = 0; i < WORDS; ++i) {
+                buffer[i] = words[i].load(std::memory_order_relaxed);
+            }
+            // Keep the data loads above from moving below the re-check
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq.load(std::memory_order_relaxed) == before) {
+                break;
+            }
+        }
+        T value;
+        std::memcpy(&value, buffer, sizeof(T));
+        return value;
+    }
+
+    // Writer: make the sequence odd, write, make it even again
+    void store(const T& value) {
+        std::lock_guard<std::mutex> lock(writeMtx);
+        publish(value);
+    }
+
+    // Read-modify-write: f receives a copy of the current value to change
+    template <typename F>
+    void update(F f) {
+        std::lock_guard<std::mutex> lock(writeMtx);
+        T value = load();   // no other writer can run: this copy is current
+        f(value);
+        publish(value);
+    }
+
+    // Number of completed writes (for demonstrations)
+    std::uint64_t version() const { return seq.load(std::memory_order_acquire) / 2; }
+};
+
+// ============================================================================
+// THE READ-MOSTLY STATE
+// ============================================================================
+// Invariant: checksum == x + y + z (a torn read would break it)
+struct Settings {
+    int lastWriter;
+    int x;
+    int y;
+    int z;
+    int checksum;
+};
+
+Settings makeSettings(int writer, int base) {
+    return Settings{writer, base, base * 2, base * 3, base * 6};
+}
+
+bool consistent(const Settings& s) {
+    return s.checksum == s.x + s.y + s.z;
+}
+
+// ============================================================================
+// READERS AND WRITERS (same shape as read_correct / write_correct)
+// ============================================================================
+// Sleep times shortened from 500ms/100ms to keep the demo fast
+std::mutex coutMtx;
+SeqLocked<Settings> settings(makeSettings(-1, 0));
+
+void write_seqlock(int i) {
+    // Prepare the new value WITHOUT any lock (the "expensive write")
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    Settings next = makeSettings(i, i * 10);
+
+    settings.store(next);   // only this short copy excludes readers
+    std::lock_guard<std::mutex> lock(coutMtx);
+    std::cout << "WRITER thread " << i << " - published version " << settings.version() << std::endl;
+}
+
+void read_seqlock(int i) {
+    Settings s = settings.load();   // no lock taken, nothing written
+    {
+        std::lock_guard<std::mutex> lock(coutMtx);
+        std::cout << "READER thread " << i << " - saw writer " << s.lastWriter
+                  << (consistent(s) ? " (consistent)" : " (TORN!)") << std::endl;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+}
+
+// ============================================================================
+// BASELINE FOR THE BENCHMARK: shared_mutex-protected Settings
+// ============================================================================
+class SharedMutexSettings {
+private:
+    mutable std::shared_mutex mtx;
+    Settings value;
+
+public:
+    explicit SharedMutexSettings(const Settings& initial) : value(initial) {}
+
+    Settings load() const {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        return value;
+    }
+
+    void store(const Settings& s) {
+        std::unique_lock<std::shared_mutex> lock(mtx);
+        value = s;
+    }
+};
+
+// numReaders threads read for 'duration' while one writer updates every 100us
+// Returns total reads per second; counts torn reads in 'torn'
+template <typename Store>
+double measureReaders(Store& store, unsigned numReaders, std::chrono::milliseconds duration, long& torn) {
+    std::atomic<bool> stop{false};
+    std::atomic<long> totalReads{0};
+    std::atomic<long> totalTorn{0};
+
+    std::thread writer([&store, &stop]() {
+        int i = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            store.store(makeSettings(0, ++i));
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+
+    std::vector<std::thread> readers;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned r = 0; r < numReaders; ++r) {
+        readers.emplace_back([&store, &stop, &totalReads, &totalTorn]() {
+            long reads = 0, bad = 0;   // thread-local counts: no shared writes in the loop
+            while (!stop.load(std::memory_order_relaxed)) {
+                Settings s = store.load();
+                if (!consistent(s)) ++bad;
+                ++reads;
+            }
+            totalReads.fetch_add(reads);
+            totalTorn.fetch_add(bad);
+        });
+    }
+
+    std::this_thread::sleep_for(duration);
+    stop.store(true);
+    for (auto& t : readers) t.join();
+    auto end = std::chrono::steady_clock::now();
+    writer.join();
+
+    torn = totalTorn.load();
+    return totalReads.load() / std::chrono::duration<double>(end - start).count();
+}
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: Same fan-out as demo_corrected (demo_007.cpp)
+void demo1_readers_writers() {
+    std::cout << "\n=== DEMO 1: Seqlock Readers and Writers ===" << std::endl;
+
+    std::vector<std::thread> threads;
+
+    // 5 readers, 2 writers, 10 readers
+    for (int i = 0; i < 5; ++i)
+        threads.push_back(std::thread{read_seqlock, i});
+    threads.push_back(std::thread{write_seqlock, 5});
+    threads.push_back(std::thread{write_seqlock, 6});
+    for (int i = 0; i < 10; ++i)
+        threads.push_back(std::thread{read_seqlock, i + 7});
+
+    for (auto& t : threads)
+        t.join();
+
+    std::cout << "Final version: " << settings.version() << " (2 writes)" << std::endl;
+}
+
+// Demo 2: update() - read-modify-write
+void demo2_update() {
+    std::cout << "\n=== DEMO 2: update() from 4 Threads ===" << std::endl;
+
+    struct Counters { long a; long b; };
+    SeqLocked<Counters> counters(Counters{0, 0});
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&counters]() {
+            for (int i = 0; i < 10000; ++i) {
+                counters.update([](Counters& c) { ++c.a; c.b += 2; });
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    Counters c = counters.load();
+    std::cout << "Expected a=40000 b=80000, got a=" << c.a << " b=" << c.b << std::endl;
+}
+
+// Demo 3: Reader throughput, 1..64 reader threads
+void demo3_benchmark() {
+    std::cout << "\n=== DEMO 3: Benchmark (reads/sec, one writer every 100us) ===" << std::endl;
+
+    const std::chrono::milliseconds duration(100);
+
+    std::cout << "readers\tshared_mutex\tSeqLocked\ttorn reads" << std::endl;
+    for (unsigned n = 1; n <= 64; n *= 2) {
+        long tornShared = 0, tornSeq = 0;
+
+        SharedMutexSettings sharedStore(makeSettings(0, 0));
+        double sharedRate = measureReaders(sharedStore, n, duration, tornShared);
+
+        SeqLocked<Settings> seqStore(makeSettings(0, 0));
+        double seqRate = measureReaders(seqStore, n, duration, tornSeq);
+
+        std::cout << n << "\t" << static_cast<long>(sharedRate) << "\t\t"
+                  << static_cast<long>(seqRate) << "\t\t"
+                  << tornShared + tornSeq << std::endl;
+    }
+
+    std::cout << "Note: the gap grows with the number of CORES running readers" << std::endl;
+    std::cout << "(hardware threads here: " << std::thread::hardware_concurrency() << ")" << std::endl;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== SEQLOCK DEMONSTRATIONS ===" << std::endl;
+
+    demo1_readers_writers();
+    demo2_update();
+    demo3_benchmark();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// SEQLOCK vs shared_mutex
+// ============================================================================
+/*
+                     shared_mutex                 SeqLocked<T>
+Reader writes        reader count (atomic RMW)    nothing
+Reader scaling       limited by one cache line    scales with cores
+Reader may block?    yes, while a writer holds    retries while a write is
+                     the lock                     in progress
+Data                 anything                     small, trivially copyable
+Reader holds a       yes (can call functions,     no - it gets a COPY
+reference?           follow pointers)
+
+Use a seqlock for small, hot, read-mostly values: timestamps, statistics,
+coordinates, a few configuration numbers.
+For large or pointer-based data use copy-on-write snapshots (RCU, next lesson).
+*/
@@ -0,0 +1,514 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+
+// ============================================================================
+// LESSON: RCU (READ-COPY-UPDATE) SNAPSHOT PUBLISHING
+// ============================================================================
+/*
+THE USE CASE (demo_007.cpp lesson header):
+    "configuration settings, caches, lookup tables"
+- Read all the time, changed rarely
+- shared_mutex readers still WRITE the shared reader count (see demo_018)
+- The seqlock (demo_018) only works for small plain data, not for a
+  table with std::vector / std::string inside
+
+THE IDEA: NEVER MODIFY, ALWAYS REPLACE
+- Readers follow a pointer to an IMMUTABLE snapshot
+- A writer COPIES the snapshot, changes the copy, and swaps the pointer
+  atomically ("publish")
+- Readers that started before the swap keep using the OLD snapshot;
+  new readers see the NEW one. Nobody ever sees a half-updated table
+
+THE HARD PART: WHEN CAN THE OLD SNAPSHOT BE DELETED?
+- Only after every reader that could still hold the old pointer is done
+- That waiting period is the GRACE PERIOD
+- Readers announce themselves cheaply: each thread has its OWN slot
+  (own cache line) where it writes the current global epoch when it
+  enters a read section and 0 when it leaves
+- synchronize(): advance the global epoch, then wait until no slot shows
+  an OLDER epoch -> all pre-existing readers have finished
+
+    reader:  enter(epoch 7) ... use old snapshot ... leave(0)
+    writer:  publish new  -> epoch 8 -> wait for slots with epoch < 8 -> delete old
+
+TWO WAYS TO FREE THE OLD SNAPSHOT:
+- synchronize(); delete old;          writer blocks for a grace period
+- call_rcu([old] { delete old; });    deferred, run by a background thread
+*/
+
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+// ============================================================================
+// GOOD EXAMPLE: RCU Domain (Epochs + Grace Periods + Deferred Callbacks)
+// ============================================================================
+class RcuDomain {
+private:
+    static constexpr std::size_t MAX_THREADS = 256;
+
+    // One slot per registered thread, each on its own cache line
+    struct alignas(CACHE_LINE_SIZE) ReaderSlot {
+        std::atomic<std::uint64_t> epoch{0};   // 0 = not in a read section
+        std::atomic<bool> inUse{false};
+    };
+
+    // Per-thread registration: claims a slot on first use, frees it at thread exit
+    struct ThreadRecord {
+        ReaderSlot* slot = nullptr;
+
+        ~ThreadRecord() {
+            if (slot) slot->inUse.store(false, std::memory_order_release);
+        }
+    };
+
+    std::atomic<std::uint64_t> globalEpoch{1};
+    ReaderSlot slots[MAX_THREADS];
+
+    // Deferred callbacks (call_rcu), run by the reclaimer thread
+    std::mutex cbMtx;
+    std::condition_variable reclaimerCv;
+    std::condition_variable barrierCv;
+    std::vector<std::function<void()>> pending;
+    unsigned long long queuedCount = 0;    // callbacks queued so far
+    unsigned long long doneCount = 0;      // callbacks executed so far
+    bool stopping = false;
+    std::thread reclaimer;                 // declared last: started after all members
+
+    ReaderSlot& mySlot() {
+        thread_local ThreadRecord record;
+        if (!record.slot) {
+            for (auto& s : slots) {
+                bool expected = false;
+                if (s.inUse.compare_exchange_strong(expected, true)) {
+                    record.slot = &s;
+                    break;
+                }
+            }
+            if (!record.slot) {
+                throw std::runtime_error("RcuDomain: too many threads");
+            }
+        }
+        return *record.slot;
+    }
+
+    static int& nesting() {
+        thread_local int depth = 0;
+        return depth;
+    }
+
+    void reclaimerLoop() {
+        std::unique_lock<std::mutex> lock(cbMtx);
+        for (;;) {
+            reclaimerCv.wait_for(lock, std::chrono::milliseconds(10),
+                                 [this]() { return stopping || !pending.empty(); });
+            if (pending.empty()) {
+                if (stopping) return;
+                continue;
+            }
+            std::vector<std::function<void()>> batch;
+            batch.swap(pending);
+            lock.unlock();
+
+            synchronize();   // ONE grace period for the whole batch
+            for (auto& callback : batch) callback();
+
+            lock.lock();
+            doneCount += batch.size();
+            barrierCv.notify_all();
+        }
+    }
+
+public:
+    RcuDomain() : reclaimer(&RcuDomain::reclaimerLoop, this) {}
+
+    // Runs all remaining callbacks before the program ends
+    ~RcuDomain() {
+        {
+            std::lock_guard<std::mutex> lock(cbMtx);
+            stopping = true;
+        }
+        reclaimerCv.notify_one();
+        reclaimer.join();
+    }
+
+    RcuDomain(const RcuDomain&) = delete;
+    RcuDomain& operator=(const RcuDomain&) = delete;
+
+    static RcuDomain& instance() {
+        static RcuDomain domain;
+        return domain;
+    }
+
+    // --- read side: only writes the calling thread's own slot ---
+    void readLock() {
+        ReaderSlot& slot = mySlot();
+        if (nesting()++ > 0) return;   // nested: the outer section already protects us
+        // seq_cst store: must be visible before we load the snapshot pointer
+        slot.epoch.store(globalEpoch.load(std::memory_order_relaxed), std::memory_order_seq_cst);
+    }
+
+    void readUnlock() {
+        if (--nesting() > 0) return;
+        mySlot().epoch.store(0, std::memory_order_release);
+    }
+
+    // --- update side ---
+
+    // Waits until every read section that started before this call has ended
+    void synchronize() {
+        std::uint64_t target = globalEpoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+        for (auto& s : slots) {
+            if (!s.inUse.load(std::memory_order_acquire)) continue;
+            for (;;) {
+                std::uint64_t e = s.epoch.load(std::memory_order_seq_cst);
+                if (e == 0 || e >= target) break;   // quiescent, or started after us
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // Runs 'callback' after a grace period, on the reclaimer thread
+    void call_rcu(std::function<void()> callback) {
+        {
+            std::lock_guard<std::mutex> lock(cbMtx);
+            pending.push_back(std::move(callback));
+            ++queuedCount;
+        }
+        reclaimerCv.notify_one();
+    }
+
+    // Waits until every callback queued before this call has run
+    void barrier() {
+        std::unique_lock<std::mutex> lock(cbMtx);
+        unsigned long long target = queuedCount;
+        reclaimerCv.notify_one();
+        barrierCv.wait(lock, [this, target]() { return doneCount >= target; });
+    }
+};
+
+// RAII read-side section
+class RcuReadGuard {
+public:
+    RcuReadGuard() { RcuDomain::instance().readLock(); }
+    ~RcuReadGuard() { RcuDomain::instance().readUnlock(); }
+
+    RcuReadGuard(const RcuReadGuard&) = delete;
+    RcuReadGuard& operator=(const RcuReadGuard&) = delete;
+};
+
+// ============================================================================
+// GOOD EXAMPLE: RcuProtected<T> - Copy-on-Write Snapshot Publishing
+// ============================================================================
+template <typename T>
+class RcuProtected {
+private:
+    std::atomic<const T*> current;
+    std::mutex writeMtx;   // writers copy-modify-publish one at a time
+
+public:
+    explicit RcuProtected(T initial) : current(new T(std::move(initial))) {}
+
+    ~RcuProtected() {
+        RcuDomain::instance().synchronize();
+        delete current.load();
+    }
+
+    RcuProtected(const RcuProtected&) = delete;
+    RcuProtected& operator=(const RcuProtected&) = delete;
+
+    // Only valid inside an RcuReadGuard, and only until the guard ends
+    const T* get() const {
+        return current.load(std::memory_order_seq_cst);
+    }
+
+    // Convenience: run f(const T&) inside a read section
+    template <typename F>
+    auto read(F f) const {
+        RcuReadGuard guard;
+        return f(*get());
+    }
+
+    // Copy, modify, publish; the old snapshot is freed after a grace period
+    // (deferred with call_rcu: the writer does not wait)
+    template <typename F>
+    void update(F modify) {
+        std::lock_guard<std::mutex> lock(writeMtx);
+        const T* old = current.load(std::memory_order_relaxed);
+        T* next = new T(*old);
+        modify(*next);
+        current.store(next, std::memory_order_seq_cst);
+        RcuDomain::instance().call_rcu([old]() { delete old; });
+    }
+
+    // Same, but waits for the grace period and frees the old snapshot itself
+    template <typename F>
+    void updateSync(F modify) {
+        const T* old;
+        {
+            std::lock_guard<std::mutex> lock(writeMtx);
+            old = current.load(std::memory_order_relaxed);
+            T* next = new T(*old);
+            modify(*next);
+            current.store(next, std::memory_order_seq_cst);
+        }
+        RcuDomain::instance().synchronize();
+        delete old;
+    }
+};
+
+// ============================================================================
+// THE READ-MOSTLY DATA: A Configuration / Lookup Table
+// ============================================================================
+std::atomic<int> liveSnapshots{0};   // to show that old snapshots are freed
+
+struct Config {
+    int version;
+    std::string name;
+    std::vector<int> table;   // lookup table: every entry == version
+
+    Config(int v, std::size_t size) : version(v), name("config"), table(size, v) {
+        ++liveSnapshots;
+    }
+    Config(const Config& other) : version(other.version), name(other.name), table(other.table) {
+        ++liveSnapshots;
+    }
+    ~Config() { --liveSnapshots; }
+
+    // A consistent snapshot has every entry equal to its version
+    bool consistent() const {
+        for (int v : table) {
+            if (v != version) return false;
+        }
+        return true;
+    }
+};
+
+void bumpVersion(Config& c) {
+    ++c.version;
+    for (int& v : c.table) v = c.version;
+}
+
+// ============================================================================
+// BASELINE: read_correct / write_correct Style (demo_007.cpp)
+// ============================================================================
+class SharedMutexConfig {
+private:
+    mutable std::shared_mutex sh_mutex;
+    Config config;
+
+public:
+    explicit SharedMutexConfig(std::size_t size) : config(0, size) {}
+
+    int lookup(std::size_t i) const {
+        std::shared_lock<std::shared_mutex> lock(sh_mutex);   // read_correct
+        return config.table[i % config.table.size()];
+    }
+
+    void bump() {
+        std::unique_lock<std::shared_mutex> lock(sh_mutex);   // write_correct
+        bumpVersion(config);
+    }
+};
+
+class RcuConfig {
+private:
+    RcuProtected<Config> config;
+
+public:
+    explicit RcuConfig(std::size_t size) : config(Config(0, size)) {}
+
+    int lookup(std::size_t i) const {
+        RcuReadGuard guard;
+        const Config* c = config.get();
+        return c->table[i % c->table.size()];
+    }
+
+    void bump() { config.update(bumpVersion); }
+};
+
+// numReaders threads look up entries for 'duration' while one writer
+// publishes a new version every millisecond. Returns lookups per second
+template <typename Store>
+double measureLookups(unsigned numReaders, std::chrono::milliseconds duration) {
+    Store store(256);
+    std::atomic<bool> stop{false};
+    std::atomic<long> totalLookups{0};
+    std::atomic<long> checksum{0};   // keeps the lookups from being optimized away
+
+    std::thread writer([&store, &stop]() {
+        while (!stop.load(std::memory_order_relaxed)) {
+            store.bump();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    std::vector<std::thread> readers;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned r = 0; r < numReaders; ++r) {
+        readers.emplace_back([&store, &stop, &totalLookups, &checksum]() {
+            long lookups = 0;
+            long sink = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                sink += store.lookup(static_cast<std::size_t>(lookups));
+                ++lookups;
+            }
+            totalLookups.fetch_add(lookups);
+            checksum.fetch_add(sink);
+        });
+    }
+
+    std::this_thread::sleep_for(duration);
+    stop.store(true);
+    for (auto& t : readers) t.join();
+    auto end = std::chrono::steady_clock::now();
+    writer.join();
+
+    return totalLookups.load() / std::chrono::duration<double>(end - start).count();
+}
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: A reader keeps its snapshot while a writer publishes a new one
+void demo1_snapshots() {
+    std::cout << "\n=== DEMO 1: Readers Keep Their Snapshot ===" << std::endl;
+
+    RcuProtected<Config> config(Config(1, 4));
+    std::atomic<bool> readerHasSnapshot{false};
+
+    std::thread reader([&config, &readerHasSnapshot]() {
+        RcuReadGuard guard;
+        const Config* c = config.get();
+        readerHasSnapshot = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));   // slow reader
+        std::cout << "Reader (still in its section) sees version " << c->version
+                  << (c->consistent() ? " (consistent)" : " (BROKEN)") << std::endl;
+    });
+
+    while (!readerHasSnapshot) std::this_thread::yield();
+
+    auto start = std::chrono::steady_clock::now();
+    config.updateSync(bumpVersion);   // must wait for the slow reader
+    auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Writer published version 2; synchronize() waited " << waited
+              << " ms for the reader" << std::endl;
+    std::cout << "New readers see version "
+              << config.read([](const Config& c) { return c.version; }) << std::endl;
+    reader.join();
+}
+
+// Demo 2: Deferred reclamation with call_rcu
+void demo2_call_rcu() {
+    std::cout << "\n=== DEMO 2: Deferred Reclamation (call_rcu) ===" << std::endl;
+
+    int before = liveSnapshots.load();
+    {
+        RcuProtected<Config> config(Config(0, 1000));
+        for (int i = 0; i < 100; ++i) {
+            config.update(bumpVersion);   // writer never waits
+        }
+        std::cout << "Snapshots alive right after 100 updates: "
+                  << liveSnapshots.load() - before << " (old ones wait for a grace period)" << std::endl;
+
+        RcuDomain::instance().barrier();  // wait for the queued deletions
+        std::cout << "Snapshots alive after barrier(): "
+                  << liveSnapshots.load() - before << " (only the current one)" << std::endl;
+    }
+}
+
+// Demo 3: Many readers, concurrent writer, every snapshot consistent
+void demo3_consistency() {
+    std::cout << "\n=== DEMO 3: Readers Always See Whole Snapshots ===" << std::endl;
+
+    RcuProtected<Config> config(Config(0, 64));
+    std::atomic<bool> stop{false};
+    std::atomic<long> broken{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&config, &stop, &broken]() {
+            while (!stop.load()) {
+                if (!config.read([](const Config& c) { return c.consistent(); })) ++broken;
+            }
+        });
+    }
+    for (int i = 0; i < 1000; ++i) {
+        config.update(bumpVersion);
+    }
+    stop = true;
+    for (auto& t : readers) t.join();
+
+    std::cout << "Final version: " << config.read([](const Config& c) { return c.version; })
+              << ", inconsistent snapshots seen: " << broken.load() << std::endl;
+    RcuDomain::instance().barrier();
+}
+
+// Demo 4: Lookup throughput vs read_correct (shared_mutex)
+void demo4_benchmark() {
+    std::cout << "\n=== DEMO 4: Benchmark (lookups/sec, one update per ms) ===" << std::endl;
+
+    const std::chrono::milliseconds duration(100);
+
+    std::cout << "readers\tshared_mutex\tRCU" << std::endl;
+    for (unsigned n = 1; n <= 16; n *= 2) {
+        double shared = measureLookups<SharedMutexConfig>(n, duration);
+        double rcu = measureLookups<RcuConfig>(n, duration);
+        std::cout << n << "\t" << static_cast<long>(shared) << "\t\t"
+                  << static_cast<long>(rcu) << std::endl;
+    }
+    RcuDomain::instance().barrier();
+
+    std::cout << "Note: RCU readers only write their own cache line; the gap grows with cores" << std::endl;
+    std::cout << "(hardware threads here: " << std::thread::hardware_concurrency() << ")" << std::endl;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== RCU DEMONSTRATIONS ===" << std::endl;
+
+    demo1_snapshots();
+    demo2_call_rcu();
+    demo3_consistency();
+    demo4_benchmark();
+
+    std::cout << "\nSnapshots still alive: " << liveSnapshots.load() << std::endl;
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// RCU RULES
+// ============================================================================
+/*
+1. READERS
+   - Only use the snapshot pointer INSIDE the read section
+   - Never block for long inside a read section: it delays every writer
+     that calls synchronize() and every call_rcu() callback
+   - Never call synchronize() inside a read section (it would wait for itself)
+
+2. WRITERS
+   - Never modify a published snapshot: copy, modify the copy, publish
+   - Writers are still serialized among themselves (writeMtx)
+   - Copying is O(size of the data): fine for rare updates, bad for
+     frequent ones
+
+3. RECLAMATION
+   - synchronize(): simple, but the writer waits for a grace period
+   - call_rcu(): the writer returns at once, memory is freed later in
+     batches (one grace period for many snapshots)
+*/
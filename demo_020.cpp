@@ -0,0 +1,327 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <random>
+
+// ============================================================================
+// LESSON: PHASE-FAIR READER-WRITER LOCK (NO WRITER STARVATION)
+// ============================================================================
+/*
+THE PROBLEM (demo_corrected in demo_007.cpp):
+- std::shared_mutex does not say who goes first when readers and a writer
+  are both waiting
+- libstdc++ on Linux uses pthread_rwlock_t, which PREFERS READERS:
+  a new reader may enter as long as any reader is inside
+- With a steady stream of overlapping read_correct calls there is ALWAYS
+  a reader inside -> write_correct waits indefinitely (WRITER STARVATION)
+
+THE SOLUTION: PHASE-FAIR LOCKING
+- Reader phases and writer phases ALTERNATE:
+    readers -> one writer -> all readers that arrived meanwhile -> next writer ...
+- A reader that arrives while a writer is WAITING or ACTIVE waits for the
+  end of that writer's phase (it does not jump ahead of the writer)
+- When a writer leaves, ALL waiting readers are admitted together,
+  BEFORE the next writer (writers cannot starve readers either)
+- Writers among themselves are served in FIFO (ticket) order
+
+BOUNDED WAITING:
+- A writer waits for at most: the current reader phase + the writers
+  queued ahead of it (each followed by one reader phase)
+- A reader waits for at most ONE writer phase
+*/
+
+// ============================================================================
+// GOOD EXAMPLE: Phase-Fair Reader-Writer Lock
+// ============================================================================
+// Same interface as std::shared_mutex (SharedMutex requirements):
+// works with std::unique_lock, std::shared_lock and std::lock_guard
+class PhaseFairSharedMutex {
+private:
+    std::mutex mtx;                     // protects everything below
+    std::condition_variable readersCv;  // readers waiting for a writer phase to end
+    std::condition_variable writersCv;  // writers waiting for their turn
+
+    int activeReaders = 0;
+    bool writerActive = false;
+    unsigned long nextTicket = 0;       // next writer ticket to hand out
+    unsigned long servingTicket = 0;    // ticket of the writer allowed to go next
+    int waitingReaders = 0;
+    unsigned long readerPhase = 0;      // incremented when waiting readers are admitted
+
+    // A writer is active or queued -> new readers must wait
+    bool writerPresent() const { return nextTicket != servingTicket; }
+
+public:
+    PhaseFairSharedMutex() = default;
+    PhaseFairSharedMutex(const PhaseFairSharedMutex&) = delete;
+    PhaseFairSharedMutex& operator=(const PhaseFairSharedMutex&) = delete;
+
+    // --- exclusive (writer) side ---
+    void lock() {
+        std::unique_lock<std::mutex> lock(mtx);
+        unsigned long myTicket = nextTicket++;   // from now on new readers wait
+        writersCv.wait(lock, [this, myTicket]() {
+            return servingTicket == myTicket && !writerActive && activeReaders == 0;
+        });
+        writerActive = true;
+    }
+
+    bool try_lock() {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (writerPresent() || activeReaders > 0) return false;
+        ++nextTicket;
+        writerActive = true;
+        return true;
+    }
+
+    void unlock() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            writerActive = false;
+            ++servingTicket;
+            // End of the writer phase: admit ALL waiting readers at once,
+            // before the next writer can start
+            if (waitingReaders > 0) {
+                activeReaders += waitingReaders;
+                waitingReaders = 0;
+                ++readerPhase;
+            }
+        }
+        readersCv.notify_all();
+        writersCv.notify_all();
+    }
+
+    // --- shared (reader) side ---
+    void lock_shared() {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (!writerPresent()) {
+            ++activeReaders;   // reader phase: join it
+            return;
+        }
+        // A writer is active or waiting: wait until a writer admits us
+        ++waitingReaders;
+        unsigned long myPhase = readerPhase;
+        readersCv.wait(lock, [this, myPhase]() { return readerPhase != myPhase; });
+        // activeReaders was already incremented for us by unlock()
+    }
+
+    bool try_lock_shared() {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (writerPresent()) return false;
+        ++activeReaders;
+        return true;
+    }
+
+    void unlock_shared() {
+        bool lastReader;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            lastReader = (--activeReaders == 0);
+        }
+        if (lastReader) {
+            writersCv.notify_all();   // the writer at the head of the queue can go
+        }
+    }
+};
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+std::mutex coutMtx;
+
+void dispMessage(const std::string& s) {
+    std::lock_guard<std::mutex> lock(coutMtx);
+    std::cout << s << std::endl;
+}
+
+double microsSince(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t).count();
+}
+
+double percentile(std::vector<double>& values, double q) {
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    std::size_t index = static_cast<std::size_t>(q * (values.size() - 1));
+    return values[index];
+}
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: A steady stream of overlapping readers vs one writer
+// 'SharedMutex' is std::shared_mutex or PhaseFairSharedMutex
+template <typename SharedMutex>
+void writerWaitUnderReaderStream(const char* name) {
+    SharedMutex sh_mutex;
+    std::atomic<bool> stop{false};
+
+    // 8 readers like read_correct: each holds the lock for 1ms, back to back
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 8; ++r) {
+        readers.emplace_back([&sh_mutex, &stop]() {
+            while (!stop.load()) {
+                std::shared_lock<SharedMutex> lock(sh_mutex);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));   // readers are running
+
+    // Like write_correct, but with a deadline: readers stop after 300ms at the latest
+    std::thread stopper([&stop]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        stop = true;
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    double waitedUs;
+    {
+        std::unique_lock<SharedMutex> lock(sh_mutex);
+        waitedUs = microsSince(start);
+    }
+
+    stopper.join();
+    for (auto& t : readers) t.join();
+
+    dispMessage(std::string(name) + ": writer waited " + std::to_string(static_cast<long>(waitedUs)) +
+                " us" + (waitedUs > 250000 ? " (starved until the readers stopped)" : ""));
+}
+
+void demo1_writer_starvation() {
+    std::cout << "\n=== DEMO 1: Writer vs a Stream of Readers ===" << std::endl;
+    writerWaitUnderReaderStream<std::shared_mutex>("std::shared_mutex   ");
+    writerWaitUnderReaderStream<PhaseFairSharedMutex>("PhaseFairSharedMutex");
+}
+
+// Demo 2: Same fan-out as demo_corrected (demo_007.cpp)
+void demo2_readers_writers() {
+    std::cout << "\n=== DEMO 2: demo_corrected with PhaseFairSharedMutex ===" << std::endl;
+
+    PhaseFairSharedMutex sh_mutex;
+    auto read_correct = [&sh_mutex](int i) {
+        std::shared_lock<PhaseFairSharedMutex> lock(sh_mutex);
+        dispMessage("READER thread " + std::to_string(i) + " - shared access");
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    };
+    auto write_correct = [&sh_mutex](int i) {
+        std::unique_lock<PhaseFairSharedMutex> lock(sh_mutex);
+        dispMessage("WRITER thread " + std::to_string(i) + " - exclusive access");
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 5; ++i)
+        threads.emplace_back(read_correct, i);
+    threads.emplace_back(write_correct, 5);
+    threads.emplace_back(write_correct, 6);
+    for (int i = 0; i < 10; ++i)
+        threads.emplace_back(read_correct, i + 7);
+
+    for (auto& t : threads)
+        t.join();
+}
+
+// Demo 3: 95% reads / 5% writes - wait-time percentiles
+template <typename SharedMutex>
+void measureMix(const char* name, unsigned numThreads, int opsPerThread) {
+    SharedMutex sh_mutex;
+    long sharedData = 0;
+
+    std::vector<std::vector<double>> writerWaits(numThreads), readerWaits(numThreads);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            std::mt19937 rng(t + 1);
+            std::uniform_int_distribution<int> dist(0, 99);
+            writerWaits[t].reserve(opsPerThread);
+            readerWaits[t].reserve(opsPerThread);
+            for (int i = 0; i < opsPerThread; ++i) {
+                auto requested = std::chrono::steady_clock::now();
+                if (dist(rng) < 5) {
+                    std::unique_lock<SharedMutex> lock(sh_mutex);
+                    writerWaits[t].push_back(microsSince(requested));
+                    ++sharedData;
+                    std::this_thread::sleep_for(std::chrono::microseconds(20));
+                } else {
+                    std::shared_lock<SharedMutex> lock(sh_mutex);
+                    readerWaits[t].push_back(microsSince(requested));
+                    volatile long copy = sharedData;
+                    (void)copy;
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<double> allWriters, allReaders;
+    for (unsigned t = 0; t < numThreads; ++t) {
+        allWriters.insert(allWriters.end(), writerWaits[t].begin(), writerWaits[t].end());
+        allReaders.insert(allReaders.end(), readerWaits[t].begin(), readerWaits[t].end());
+    }
+
+    std::cout << name << "\t" << static_cast<long>(numThreads * opsPerThread / seconds) << "\t\t"
+              << static_cast<long>(percentile(allWriters, 0.50)) << "\t"
+              << static_cast<long>(percentile(allWriters, 0.99)) << "\t"
+              << static_cast<long>(percentile(allWriters, 1.0)) << "\t"
+              << static_cast<long>(percentile(allReaders, 0.99)) << std::endl;
+}
+
+void demo3_benchmark() {
+    std::cout << "\n=== DEMO 3: Benchmark (95% read / 5% write, 16 threads) ===" << std::endl;
+    std::cout << "Readers hold the lock 100us, writers 20us; wait times in us" << std::endl;
+
+    std::cout << "lock\t\t\tops/sec\t\tW p50\tW p99\tW max\tR p99" << std::endl;
+    measureMix<std::shared_mutex>("std::shared_mutex", 16, 1000);
+    measureMix<PhaseFairSharedMutex>("PhaseFairSharedMutex", 16, 1000);
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== PHASE-FAIR READER-WRITER LOCK DEMONSTRATIONS ===" << std::endl;
+
+    demo1_writer_starvation();
+    demo2_readers_writers();
+    demo3_benchmark();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// FAIRNESS POLICIES FOR READER-WRITER LOCKS
+// ============================================================================
+/*
+READER PREFERENCE (glibc pthread_rwlock default, std::shared_mutex on Linux):
+- Best reader throughput
+- Writers can starve forever
+
+WRITER PREFERENCE:
+- Writers never starve
+- A stream of writers starves the readers instead
+
+TASK-FAIR (strict FIFO):
+- Everyone is served in arrival order
+- Readers only share the lock with readers that arrived next to them:
+  R W R W R W -> almost no reader parallelism
+
+PHASE-FAIR (this lesson):
+- Reader and writer phases alternate
+- Readers still run in parallel (all readers waiting for a writer go together)
+- Both sides have a bounded wait
+*/
@@ -0,0 +1,370 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+
+// ============================================================================
+// LESSON: DISTRIBUTED READER-WRITER LOCK (BIG-READER LOCK)
+// ============================================================================
+/*
+THE PROBLEM:
+- sh_mutex in demo_007.cpp keeps ONE reader count
+- Every shared_lock / unlock writes that count -> with readers on many
+  cores the cache line holding it "ping-pongs" between them
+- At extreme read ratios (99.9%+ reads) this one cache line limits the
+  whole program, even though readers never block each other logically
+
+THE SOLUTION: ONE READER INDICATOR PER THREAD SLOT
+- The lock has N slots, each on its OWN cache line
+- A reader increments only ITS slot -> readers on different cores never
+  touch the same cache line
+- A writer raises a global "writer" flag and then SWEEPS all slots,
+  waiting until every slot shows zero readers
+
+        slot 0  [ readers: 1 ]   <- thread 0 only
+        slot 1  [ readers: 0 ]   <- thread 1 only
+        slot 2  [ readers: 2 ]   <- threads 2 and 2+N
+        ...
+        writer flag [ 0 ]        <- read by readers, written only by writers
+
+TRADE-OFF:
+- Reads: almost free and perfectly scalable
+- Writes: O(number of slots) and much more expensive than a normal lock
+- Memory: N cache lines per lock instead of one word
+-> Use it only where writes are RARE (configuration, routing tables, ...)
+*/
+
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+// ============================================================================
+// GOOD EXAMPLE: BigReaderLock
+// ============================================================================
+// Meets the SharedMutex requirements: works with std::shared_lock,
+// std::unique_lock and std::lock_guard
+class BigReaderLock {
+private:
+    struct alignas(CACHE_LINE_SIZE) ReaderSlot {
+        std::atomic<int> readers{0};
+    };
+
+    std::unique_ptr<ReaderSlot[]> slots;
+    std::size_t slotMask;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> writer{false};
+    std::mutex writerMtx;   // writers are serialized among themselves
+
+    // Each thread always uses the same slot, so unlock_shared() finds it again
+    static std::size_t threadIndex() {
+        static std::atomic<std::size_t> nextIndex{0};
+        thread_local const std::size_t index = nextIndex.fetch_add(1);
+        return index;
+    }
+
+    ReaderSlot& mySlot() { return slots[threadIndex() & slotMask]; }
+
+    static void backoff(int& spins) {
+        if (++spins < 64) return;          // short busy wait first
+        std::this_thread::yield();         // then give the CPU away
+    }
+
+    // Wait until every reader slot is empty (writer flag is already set)
+    void waitForReaders() {
+        for (std::size_t i = 0; i <= slotMask; ++i) {
+            int spins = 0;
+            while (slots[i].readers.load(std::memory_order_seq_cst) != 0) {
+                backoff(spins);
+            }
+        }
+    }
+
+public:
+    // Default: one slot per hardware thread (at least 8), a power of two
+    explicit BigReaderLock(std::size_t numSlots = std::max(8u, std::thread::hardware_concurrency())) {
+        std::size_t n = 1;
+        while (n < numSlots) n <<= 1;
+        slots.reset(new ReaderSlot[n]);
+        slotMask = n - 1;
+    }
+
+    BigReaderLock(const BigReaderLock&) = delete;
+    BigReaderLock& operator=(const BigReaderLock&) = delete;
+
+    // --- shared (reader) side: touches only this thread's slot ---
+    void lock_shared() {
+        ReaderSlot& slot = mySlot();
+        for (;;) {
+            // Announce first, then check for a writer (the writer does the
+            // opposite: flag first, then check the slots) - seq_cst on both
+            // sides guarantees that at least one of them sees the other
+            slot.readers.fetch_add(1, std::memory_order_seq_cst);
+            if (!writer.load(std::memory_order_seq_cst)) {
+                return;
+            }
+            // A writer is active or waiting: step back and let it run
+            slot.readers.fetch_sub(1, std::memory_order_release);
+            int spins = 0;
+            while (writer.load(std::memory_order_relaxed)) {
+                backoff(spins);
+            }
+        }
+    }
+
+    bool try_lock_shared() {
+        ReaderSlot& slot = mySlot();
+        slot.readers.fetch_add(1, std::memory_order_seq_cst);
+        if (!writer.load(std::memory_order_seq_cst)) {
+            return true;
+        }
+        slot.readers.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+
+    void unlock_shared() {
+        mySlot().readers.fetch_sub(1, std::memory_order_release);
+    }
+
+    // --- exclusive (writer) side: sweeps all slots ---
+    void lock() {
+        writerMtx.lock();
+        writer.store(true, std::memory_order_seq_cst);   // new readers back off
+        waitForReaders();                                 // existing readers drain
+    }
+
+    bool try_lock() {
+        if (!writerMtx.try_lock()) return false;
+        writer.store(true, std::memory_order_seq_cst);
+        for (std::size_t i = 0; i <= slotMask; ++i) {
+            if (slots[i].readers.load(std::memory_order_seq_cst) != 0) {
+                writer.store(false, std::memory_order_release);
+                writerMtx.unlock();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void unlock() {
+        writer.store(false, std::memory_order_release);
+        writerMtx.unlock();
+    }
+
+    std::size_t slotCount() const { return slotMask + 1; }
+};
+
+// ============================================================================
+// THE READ-MOSTLY STATE (like demo_007.cpp, without console output)
+// ============================================================================
+template <typename SharedMutex>
+class RoutingTable {
+private:
+    mutable SharedMutex sh_mutex;
+    int routes[16] = {};
+
+public:
+    // read_correct: shared access
+    int lookup(int key) const {
+        std::shared_lock<SharedMutex> lock(sh_mutex);
+        return routes[key & 15];
+    }
+
+    // write_correct: exclusive access
+    void update(int value) {
+        std::unique_lock<SharedMutex> lock(sh_mutex);
+        for (int& r : routes) r = value;
+    }
+
+    // All routes equal - otherwise a reader saw a half-finished update
+    bool consistent() const {
+        std::shared_lock<SharedMutex> lock(sh_mutex);
+        for (int r : routes) {
+            if (r != routes[0]) return false;
+        }
+        return true;
+    }
+};
+
+// numReaders threads call lookup() for 'duration'; one writer updates every 'writePeriod'
+// Returns lookups per second
+template <typename SharedMutex>
+double measureLookups(unsigned numReaders, std::chrono::milliseconds duration,
+                      std::chrono::microseconds writePeriod) {
+    RoutingTable<SharedMutex> table;
+    std::atomic<bool> stop{false};
+    std::atomic<long> totalLookups{0};
+    std::atomic<long> checksum{0};   // keeps the lookups from being optimized away
+
+    std::thread writer([&table, &stop, writePeriod]() {
+        int value = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            table.update(++value);
+            std::this_thread::sleep_for(writePeriod);
+        }
+    });
+
+    std::vector<std::thread> readers;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned r = 0; r < numReaders; ++r) {
+        readers.emplace_back([&table, &stop, &totalLookups, &checksum]() {
+            long lookups = 0, sum = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                sum += table.lookup(static_cast<int>(lookups));
+                ++lookups;
+            }
+            totalLookups.fetch_add(lookups);
+            checksum.fetch_add(sum);
+        });
+    }
+
+    std::this_thread::sleep_for(duration);
+    stop.store(true);
+    for (auto& t : readers) t.join();
+    auto end = std::chrono::steady_clock::now();
+    writer.join();
+
+    return totalLookups.load() / std::chrono::duration<double>(end - start).count();
+}
+
+// Cost of one uncontended lock()/unlock() pair in nanoseconds
+template <typename SharedMutex>
+double writerCostNs(SharedMutex& m, int iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        std::lock_guard<SharedMutex> lock(m);
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+template <typename SharedMutex>
+double readerCostNs(SharedMutex& m, int iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        std::shared_lock<SharedMutex> lock(m);
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: Standard lock types work with BigReaderLock
+void demo1_interface() {
+    std::cout << "\n=== DEMO 1: Works with std::shared_lock / std::unique_lock ===" << std::endl;
+
+    BigReaderLock sh_mutex;
+    std::cout << "Reader slots: " << sh_mutex.slotCount()
+              << " (" << sh_mutex.slotCount() * CACHE_LINE_SIZE << " bytes)" << std::endl;
+
+    {
+        std::shared_lock<BigReaderLock> r1(sh_mutex);
+        std::cout << "Shared lock held; try_lock() for a writer: "
+                  << (sh_mutex.try_lock() ? "succeeded (BUG)" : "fails as expected") << std::endl;
+    }
+    {
+        std::unique_lock<BigReaderLock> w(sh_mutex);
+        std::cout << "Exclusive lock held; try_lock_shared(): "
+                  << (sh_mutex.try_lock_shared() ? "succeeded (BUG)" : "fails as expected") << std::endl;
+    }
+}
+
+// Demo 2: Readers and writers together - no torn updates
+void demo2_correctness() {
+    std::cout << "\n=== DEMO 2: 8 Readers + 2 Writers ===" << std::endl;
+
+    RoutingTable<BigReaderLock> table;
+    std::atomic<bool> stop{false};
+    std::atomic<long> torn{0};
+
+    std::vector<std::thread> threads;
+    for (int r = 0; r < 8; ++r) {
+        threads.emplace_back([&table, &stop, &torn]() {
+            while (!stop.load()) {
+                if (!table.consistent()) ++torn;
+            }
+        });
+    }
+    for (int w = 0; w < 2; ++w) {
+        threads.emplace_back([&table, w]() {
+            for (int i = 0; i < 2000; ++i) table.update(w * 10000 + i);
+        });
+    }
+    threads[8].join();
+    threads[9].join();
+    stop = true;
+    for (int r = 0; r < 8; ++r) threads[r].join();
+
+    std::cout << "Inconsistent reads: " << torn.load() << std::endl;
+}
+
+// Demo 3: Reader scaling and the price paid by writers
+void demo3_benchmark() {
+    std::cout << "\n=== DEMO 3: Benchmark (lookups/sec, one write per ms) ===" << std::endl;
+
+    const std::chrono::milliseconds duration(100);
+    const std::chrono::microseconds writePeriod(1000);
+    unsigned maxThreads = std::max(16u, 2 * std::thread::hardware_concurrency());
+
+    std::cout << "readers\tshared_mutex\tBigReaderLock" << std::endl;
+    for (unsigned n = 1; n <= maxThreads; n *= 2) {
+        double shared = measureLookups<std::shared_mutex>(n, duration, writePeriod);
+        double big = measureLookups<BigReaderLock>(n, duration, writePeriod);
+        std::cout << n << "\t" << static_cast<long>(shared) << "\t\t"
+                  << static_cast<long>(big) << std::endl;
+    }
+
+    // Uncontended cost of each side
+    std::shared_mutex sm;
+    BigReaderLock br;
+    const int iterations = 1000000;
+    std::cout << "\nuncontended cost (ns)\tshared_mutex\tBigReaderLock" << std::endl;
+    std::cout << "reader lock+unlock\t" << readerCostNs(sm, iterations) << "\t\t"
+              << readerCostNs(br, iterations) << std::endl;
+    std::cout << "writer lock+unlock\t" << writerCostNs(sm, iterations) << "\t\t"
+              << writerCostNs(br, iterations) << "  (sweeps " << br.slotCount() << " slots)" << std::endl;
+
+    std::cout << "Note: reader scaling needs readers on separate cores" << std::endl;
+    std::cout << "(hardware threads here: " << std::thread::hardware_concurrency() << ")" << std::endl;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== BIG-READER LOCK DEMONSTRATIONS ===" << std::endl;
+
+    demo1_interface();
+    demo2_correctness();
+    demo3_benchmark();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// CHOOSING A READER-WRITER LOCK
+// ============================================================================
+/*
+std::shared_mutex (demo_007):
+- Small, general purpose; one shared reader count
+
+PhaseFairSharedMutex (demo_020):
+- Bounded waiting for readers AND writers
+
+BigReaderLock (this lesson):
+- Readers scale with cores: each writes only its own cache line
+- Writers are expensive (sweep all slots) and PREFERRED: a waiting writer
+  makes new readers back off, so a constant stream of writers starves readers
+- N cache lines per lock: use a few of them for hot global data, not
+  one per object
+
+SeqLocked / RCU (demo_018, demo_019):
+- Readers write NOTHING shared at all - even cheaper, but readers get a
+  copy / snapshot instead of locked access to the live data
+*/
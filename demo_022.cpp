@@ -0,0 +1,388 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <stack>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <linux/futex.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// ============================================================================
+// LESSON: ADAPTIVE SPIN-THEN-PARK MUTEX (LINUX FUTEX)
+// ============================================================================
+/*
+THE PROBLEM:
+- SafeCounter::increment, SafeStack::push and dispMessage2 hold their
+  mutex for a few NANOSECONDS
+- When std::mutex is contended, the waiting thread is put to sleep in the
+  kernel (futex wait) and has to be woken up again (futex wake):
+  two system calls + two context switches = several MICROSECONDS
+- The lock was probably free again long before the sleeping thread was
+  even descheduled
+
+THE SOLUTION: SPIN FIRST, THEN PARK
+- SPIN: keep trying for a short while, with the CPU's PAUSE instruction
+  and exponential backoff between attempts (less traffic on the cache line)
+- PARK: if the lock is still taken, sleep in the kernel on a futex
+- ADAPTIVE: each mutex learns how long spinning usually takes
+    spinning succeeded -> allow a bit more spinning next time
+    spinning failed    -> spin less next time (it was wasted CPU)
+
+THE FUTEX ("fast userspace mutex"):
+- The lock word lives in normal memory; the kernel is only involved when
+  a thread must sleep or be woken
+- Lock word states (Ulrich Drepper, "Futexes Are Tricky"):
+    0 = unlocked
+    1 = locked, nobody sleeping
+    2 = locked, maybe sleepers -> unlock() must call FUTEX_WAKE
+*/
+
+// ============================================================================
+// CPU HINT FOR SPIN LOOPS
+// ============================================================================
+// PAUSE tells the CPU "this is a spin-wait": saves power, frees resources
+// for the other hyper-thread, and avoids a pipeline flush when the lock
+// word finally changes
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// ============================================================================
+// FUTEX WRAPPERS
+// ============================================================================
+static_assert(sizeof(std::atomic<int>) == sizeof(int), "futex needs a plain 32-bit word");
+
+// Sleep while *addr == expected (returns at once if it already changed)
+inline void futexWait(std::atomic<int>& word, int expected) {
+    syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+// Wake up to 'count' threads sleeping on addr
+inline void futexWake(std::atomic<int>& word, int count) {
+    syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+// ============================================================================
+// GOOD EXAMPLE: SpinThenParkMutex
+// ============================================================================
+// Same interface as std::mutex: works with std::lock_guard,
+// std::unique_lock, std::scoped_lock and as mutex_t
+class SpinThenParkMutex {
+private:
+    static constexpr int UNLOCKED = 0;
+    static constexpr int LOCKED = 1;
+    static constexpr int CONTENDED = 2;
+
+    static constexpr int MIN_SPIN = 16;      // PAUSE instructions
+    static constexpr int MAX_SPIN = 4096;
+    static constexpr int MAX_BACKOFF = 64;   // PAUSEs between two attempts
+
+    std::atomic<int> state{UNLOCKED};
+    std::atomic<int> spinBudget{256};   // learned; a hint, so relaxed access is fine
+
+    bool tryAcquire() {
+        int expected = UNLOCKED;
+        return state.compare_exchange_strong(expected, LOCKED, std::memory_order_acquire,
+                                             std::memory_order_relaxed);
+    }
+
+    // Spin with exponential backoff; returns true if the lock was taken
+    bool spin() {
+        const int budget = spinBudget.load(std::memory_order_relaxed);
+        int spent = 0;
+        int backoff = 1;
+        while (spent < budget) {
+            // Test before test-and-set: only try the CAS when the lock looks free
+            if (state.load(std::memory_order_relaxed) == UNLOCKED && tryAcquire()) {
+                // Success: give future lockers a little more room than we needed
+                int target = std::min(MAX_SPIN, std::max(MIN_SPIN, 2 * spent));
+                spinBudget.store(budget + (target - budget) / 8, std::memory_order_relaxed);
+                return true;
+            }
+            for (int i = 0; i < backoff; ++i) cpuRelax();
+            spent += backoff;
+            backoff = std::min(2 * backoff, MAX_BACKOFF);
+        }
+        // Failure: the spinning was wasted, spin less next time
+        spinBudget.store(std::max(MIN_SPIN, budget / 2), std::memory_order_relaxed);
+        return false;
+    }
+
+public:
+    SpinThenParkMutex() = default;
+    SpinThenParkMutex(const SpinThenParkMutex&) = delete;
+    SpinThenParkMutex& operator=(const SpinThenParkMutex&) = delete;
+
+    void lock() {
+        if (tryAcquire()) return;   // uncontended: one CAS, like std::mutex
+        if (spin()) return;         // short critical section: got it while spinning
+
+        // Park: mark the lock CONTENDED and sleep until it may be free
+        // exchange() also takes the lock if it was released meanwhile
+        while (state.exchange(CONTENDED, std::memory_order_acquire) != UNLOCKED) {
+            futexWait(state, CONTENDED);
+        }
+        // We own the lock in state CONTENDED: our unlock() will wake the
+        // next sleeper (possibly unnecessarily - harmless)
+    }
+
+    bool try_lock() {
+        return tryAcquire();
+    }
+
+    void unlock() {
+        // LOCKED -> UNLOCKED needs no system call; CONTENDED means someone may sleep
+        if (state.exchange(UNLOCKED, std::memory_order_release) == CONTENDED) {
+            futexWake(state, 1);
+        }
+    }
+
+    int currentSpinBudget() const { return spinBudget.load(std::memory_order_relaxed); }
+};
+
+// ============================================================================
+// CONTEXT-SWITCH COUNTER
+// ============================================================================
+// Voluntary (thread blocked) + involuntary (preempted) switches of this process
+long contextSwitches() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_nvcsw + usage.ru_nivcsw;
+}
+
+// ============================================================================
+// THE THREE CALL SITES (demo_004.cpp, demo_005.cpp), TEMPLATED ON THE MUTEX
+// ============================================================================
+
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+NullBuffer nullBuffer;
+std::ostream nullOut(&nullBuffer);
+
+// From demo_004.cpp
+template <typename Mutex>
+struct Display {
+    Mutex mtx;
+
+    void dispMessage2(const std::string& s) {
+        std::lock_guard<Mutex> lock(mtx);
+        nullOut << s << "\n";
+    }
+};
+
+// From demo_005.cpp
+template <typename Mutex>
+class SafeCounter {
+private:
+    mutable Mutex mtx;
+    int count;
+
+public:
+    SafeCounter() : count(0) {}
+
+    void increment() {
+        std::lock_guard<Mutex> lock(mtx);
+        ++count;
+    }
+
+    int getCount() const {
+        std::lock_guard<Mutex> lock(mtx);
+        return count;
+    }
+};
+
+// From demo_005.cpp
+template <typename Mutex>
+class SafeStack {
+private:
+    mutable Mutex mtx;
+    std::stack<int> data;
+
+public:
+    void push(int value) {
+        std::lock_guard<Mutex> lock(mtx);
+        data.push(value);
+    }
+
+    std::size_t size() const {
+        std::lock_guard<Mutex> lock(mtx);
+        return data.size();
+    }
+};
+
+// ============================================================================
+// BENCHMARK HELPER
+// ============================================================================
+struct Result {
+    double opsPerSec;
+    long switches;
+};
+
+// numThreads threads call op() opsPerThread times each
+template <typename Op>
+Result measure(unsigned numThreads, int opsPerThread, Op op) {
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&go, &op, opsPerThread]() {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (int i = 0; i < opsPerThread; ++i) op(i);
+        });
+    }
+
+    long switchesBefore = contextSwitches();
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) t.join();
+    auto end = std::chrono::steady_clock::now();
+    long switches = contextSwitches() - switchesBefore;
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return Result{numThreads * opsPerThread / seconds, switches};
+}
+
+void printRow(unsigned threads, const Result& a, const Result& b) {
+    std::cout << threads << "\t" << static_cast<long>(a.opsPerSec) << "\t" << a.switches << "\t\t"
+              << static_cast<long>(b.opsPerSec) << "\t" << b.switches << std::endl;
+}
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: Drop-in replacement for mutex_t
+typedef SpinThenParkMutex mutex_t;   // was: typedef std::mutex mutex_t; (demo_004.cpp)
+mutex_t mtx;
+
+void dispMessage2(const std::string& s) {
+    std::lock_guard<mutex_t> lock(mtx);
+    std::cout << s << std::endl;
+}
+
+void demo1_drop_in() {
+    std::cout << "\n=== DEMO 1: SpinThenParkMutex as mutex_t ===" << std::endl;
+
+    std::thread t1([]() {
+        for (int i = 0; i < 3; ++i) dispMessage2("T1 ---");
+    });
+    for (int i = 0; i < 3; ++i) dispMessage2("--- main");
+    t1.join();
+
+    SafeCounter<mutex_t> counter;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&counter]() {
+            for (int i = 0; i < 100000; ++i) counter.increment();
+        });
+    }
+    for (auto& t : threads) t.join();
+    std::cout << "SafeCounter<SpinThenParkMutex>: expected 400000, got " << counter.getCount() << std::endl;
+}
+
+// Demo 2: Throughput and context switches on the three call sites
+void demo2_benchmark() {
+    std::cout << "\n=== DEMO 2: Benchmark (ops/sec and context switches) ===" << std::endl;
+
+    const int opsPerThread = 200000;
+
+    std::cout << "\n--- SafeCounter::increment ---" << std::endl;
+    std::cout << "threads\tstd::mutex\tswitches\tSpinThenPark\tswitches" << std::endl;
+    for (unsigned n = 2; n <= 8; n *= 2) {
+        SafeCounter<std::mutex> a;
+        SafeCounter<SpinThenParkMutex> b;
+        Result ra = measure(n, opsPerThread, [&a](int) { a.increment(); });
+        Result rb = measure(n, opsPerThread, [&b](int) { b.increment(); });
+        printRow(n, ra, rb);
+    }
+
+    std::cout << "\n--- SafeStack::push ---" << std::endl;
+    std::cout << "threads\tstd::mutex\tswitches\tSpinThenPark\tswitches" << std::endl;
+    for (unsigned n = 2; n <= 8; n *= 2) {
+        SafeStack<std::mutex> a;
+        SafeStack<SpinThenParkMutex> b;
+        Result ra = measure(n, opsPerThread, [&a](int i) { a.push(i); });
+        Result rb = measure(n, opsPerThread, [&b](int i) { b.push(i); });
+        printRow(n, ra, rb);
+    }
+
+    std::cout << "\n--- dispMessage2 ---" << std::endl;
+    std::cout << "threads\tstd::mutex\tswitches\tSpinThenPark\tswitches" << std::endl;
+    for (unsigned n = 2; n <= 8; n *= 2) {
+        Display<std::mutex> a;
+        Display<SpinThenParkMutex> b;
+        Result ra = measure(n, opsPerThread / 4, [&a](int) { a.dispMessage2("T1 ---"); });
+        Result rb = measure(n, opsPerThread / 4, [&b](int) { b.dispMessage2("T1 ---"); });
+        printRow(n, ra, rb);
+    }
+
+    std::cout << "\nNote: spinning only pays off when the lock holder runs on ANOTHER core;" << std::endl;
+    std::cout << "with fewer cores than threads the budget adapts down and the mutex parks" << std::endl;
+    std::cout << "(hardware threads here: " << std::thread::hardware_concurrency() << ")" << std::endl;
+}
+
+// Demo 3: The spin budget adapts to the workload
+void demo3_adaptation() {
+    std::cout << "\n=== DEMO 3: Adaptive Spin Budget ===" << std::endl;
+
+    SpinThenParkMutex m;
+    std::cout << "Initial budget: " << m.currentSpinBudget() << " PAUSEs" << std::endl;
+
+    // Long critical sections: spinning never succeeds -> budget shrinks
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 2; ++t) {
+        threads.emplace_back([&m]() {
+            for (int i = 0; i < 20; ++i) {
+                std::lock_guard<SpinThenParkMutex> lock(m);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    std::cout << "After 1ms critical sections: " << m.currentSpinBudget() << " PAUSEs" << std::endl;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== SPIN-THEN-PARK MUTEX DEMONSTRATIONS ===" << std::endl;
+
+    demo1_drop_in();
+    demo2_benchmark();
+    demo3_adaptation();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// WHEN SPINNING HELPS - AND WHEN IT HURTS
+// ============================================================================
+/*
+HELPS:
+- Critical sections of nanoseconds (counters, push/pop, small updates)
+- Lock holder and waiter run on DIFFERENT cores at the same time
+
+HURTS:
+- More runnable threads than cores: the lock holder may be preempted,
+  spinning then only burns the CPU the holder needs -> the adaptive
+  budget shrinks quickly in that case
+- Long critical sections (I/O, sleeping): park immediately instead
+
+NOTE: glibc offers the same idea as PTHREAD_MUTEX_ADAPTIVE_NP, but
+std::mutex uses the default (non-spinning) pthread mutex type.
+*/
@@ -0,0 +1,431 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <memory>
+#include <cstdint>
+
+// ============================================================================
+// LESSON: PARKING-LOT MUTEXES (ONE BYTE PER LOCK)
+// ============================================================================
+/*
+THE PROBLEM: std::mutex IS BIG
+- sizeof(std::mutex) is 40 bytes on Linux (a whole pthread_mutex_t)
+- Logger1..Logger4 (demo_006.cpp) carry two of them: 80 bytes of locks
+- SafeCounter (demo_005.cpp) is 4 bytes of data + 40 bytes of mutex
+- With millions of small protected objects most of the memory (and most
+  of every cache line) is spent on locks that are almost never contended
+
+THE OBSERVATION:
+- A lock only needs space for WAITING threads while threads are waiting
+- At any moment only a handful of locks have waiters
+  (at most one per thread!)
+
+THE SOLUTION: A PARKING LOT (WebKit's WTF::Lock, Rust's parking_lot)
+- Each mutex is ONE BYTE: bit 0 = locked, bit 1 = threads are parked
+- Waiting threads are kept in ONE GLOBAL HASH TABLE, keyed by the
+  address of the lock byte:
+
+        lock byte @0x1000 ──hash──► bucket 17: [thread A] -> [thread C]
+        lock byte @0x2040 ──hash──► bucket 93: [thread B]
+
+- park(addr):   put the current thread into addr's bucket and sleep
+- unparkOne(addr): wake the first thread parked on addr
+- Fast path (no contention) never touches the table: one CAS on the byte
+*/
+
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+// ============================================================================
+// THE PARKING LOT: Global Hashed Table of Wait Queues
+// ============================================================================
+namespace parking_lot {
+
+// One per thread; lives in a queue only while the thread is parked
+struct Waiter {
+    const void* address = nullptr;
+    Waiter* next = nullptr;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool woken = false;
+};
+
+struct alignas(CACHE_LINE_SIZE) Bucket {
+    std::mutex mtx;             // protects the queue
+    Waiter* head = nullptr;
+    Waiter* tail = nullptr;
+};
+
+constexpr std::size_t BUCKET_COUNT = 256;   // shared by ALL locks in the program
+Bucket buckets[BUCKET_COUNT];
+
+inline Bucket& bucketFor(const void* address) {
+    // Fibonacci hashing: multiply by 2^64 / golden ratio, keep the top bits
+    std::uint64_t h = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(address)) *
+                      0x9E3779B97F4A7C15ull;
+    return buckets[h >> 56];
+}
+
+inline Waiter& currentWaiter() {
+    thread_local Waiter waiter;
+    return waiter;
+}
+
+// Parks the calling thread on 'address' if validate() is still true
+// (checked under the bucket lock, so no wake-up can be missed)
+// Returns false if validate() failed and the thread did not sleep
+template <typename Validate>
+bool park(const void* address, Validate validate) {
+    Bucket& bucket = bucketFor(address);
+    Waiter& me = currentWaiter();
+    {
+        std::lock_guard<std::mutex> lock(bucket.mtx);
+        if (!validate()) {
+            return false;
+        }
+        me.address = address;
+        me.next = nullptr;
+        {
+            std::lock_guard<std::mutex> wlock(me.mtx);
+            me.woken = false;
+        }
+        if (bucket.tail) bucket.tail->next = &me;
+        else bucket.head = &me;
+        bucket.tail = &me;
+    }
+    std::unique_lock<std::mutex> wlock(me.mtx);
+    me.cv.wait(wlock, [&me]() { return me.woken; });
+    return true;
+}
+
+// Wakes the first thread parked on 'address'
+// callback(didUnpark, moreWaiters) runs under the bucket lock, so the lock
+// byte can be updated consistently with the queue
+template <typename Callback>
+void unparkOne(const void* address, Callback callback) {
+    Bucket& bucket = bucketFor(address);
+    Waiter* woken = nullptr;
+    bool moreWaiters = false;
+    {
+        std::lock_guard<std::mutex> lock(bucket.mtx);
+        Waiter* prev = nullptr;
+        Waiter** link = &bucket.head;
+        while (*link) {
+            Waiter* w = *link;
+            if (w->address == address) {
+                if (woken) {
+                    moreWaiters = true;   // a second waiter for the same lock
+                    break;
+                }
+                // Unlink the first waiter for this address
+                woken = w;
+                *link = w->next;
+                if (bucket.tail == w) bucket.tail = prev;
+                continue;
+            }
+            prev = w;
+            link = &w->next;
+        }
+        callback(woken != nullptr, moreWaiters);
+    }
+    if (woken) {
+        std::lock_guard<std::mutex> wlock(woken->mtx);
+        woken->woken = true;
+        woken->cv.notify_one();
+    }
+}
+
+} // namespace parking_lot
+
+// ============================================================================
+// GOOD EXAMPLE: ParkingMutex (1 byte)
+// ============================================================================
+// Same interface as std::mutex: works with std::lock_guard, std::unique_lock,
+// std::lock and as mutex_t
+class ParkingMutex {
+private:
+    static constexpr std::uint8_t LOCKED = 1;
+    static constexpr std::uint8_t PARKED = 2;   // at least one thread may be parked
+
+    std::atomic<std::uint8_t> state{0};
+
+    void lockSlow() {
+        int spins = 0;
+        for (;;) {
+            std::uint8_t s = state.load(std::memory_order_relaxed);
+
+            // Free: try to take it (keep the PARKED bit for the others)
+            if (!(s & LOCKED)) {
+                if (state.compare_exchange_weak(s, s | LOCKED, std::memory_order_acquire,
+                                                std::memory_order_relaxed)) {
+                    return;
+                }
+                continue;
+            }
+
+            // Nobody parked yet: spin a little before going to sleep
+            if (!(s & PARKED) && spins < 40) {
+                ++spins;
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Announce that we will park
+            if (!(s & PARKED)) {
+                if (!state.compare_exchange_weak(s, s | PARKED, std::memory_order_relaxed)) {
+                    continue;
+                }
+            }
+
+            // Sleep only if the byte still says "locked, with parked threads"
+            parking_lot::park(&state, [this]() {
+                return state.load(std::memory_order_relaxed) == (LOCKED | PARKED);
+            });
+        }
+    }
+
+    void unlockSlow() {
+        parking_lot::unparkOne(&state, [this](bool, bool moreWaiters) {
+            // Release the lock; keep PARKED if others are still waiting
+            state.store(moreWaiters ? PARKED : 0, std::memory_order_release);
+        });
+    }
+
+public:
+    ParkingMutex() = default;
+    ParkingMutex(const ParkingMutex&) = delete;
+    ParkingMutex& operator=(const ParkingMutex&) = delete;
+
+    void lock() {
+        std::uint8_t expected = 0;
+        if (state.compare_exchange_weak(expected, LOCKED, std::memory_order_acquire,
+                                        std::memory_order_relaxed)) {
+            return;   // fast path: one CAS, the table is never touched
+        }
+        lockSlow();
+    }
+
+    bool try_lock() {
+        std::uint8_t s = state.load(std::memory_order_relaxed);
+        while (!(s & LOCKED)) {
+            if (state.compare_exchange_weak(s, s | LOCKED, std::memory_order_acquire,
+                                            std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void unlock() {
+        std::uint8_t expected = LOCKED;
+        if (state.compare_exchange_strong(expected, 0, std::memory_order_release,
+                                          std::memory_order_relaxed)) {
+            return;   // fast path: nobody parked
+        }
+        unlockSlow();
+    }
+};
+
+// ============================================================================
+// CLASSES FROM EARLIER DEMOS, TEMPLATED ON THE MUTEX
+// ============================================================================
+
+// From demo_005.cpp
+template <typename Mutex>
+class SafeCounter {
+private:
+    mutable Mutex mtx;
+    int count;
+
+public:
+    SafeCounter() : count(0) {}
+
+    void increment() {
+        std::lock_guard<Mutex> lock(mtx);
+        ++count;
+    }
+
+    int getCount() const {
+        std::lock_guard<Mutex> lock(mtx);
+        return count;
+    }
+};
+
+// Shape of Logger1..Logger4 from demo_006.cpp (two mutexes, without the file)
+template <typename Mutex>
+class Logger3 {
+    Mutex mtx;
+    Mutex mtx2;
+    int lines = 0;
+
+public:
+    void log() {
+        std::lock(mtx, mtx2);
+        std::lock_guard<Mutex> lock(mtx, std::adopt_lock);
+        std::lock_guard<Mutex> lock2(mtx2, std::adopt_lock);
+        ++lines;
+    }
+};
+
+// ============================================================================
+// BENCHMARK HELPERS
+// ============================================================================
+template <typename Op>
+double opsPerSecond(unsigned numThreads, long opsPerThread, Op op) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&op, opsPerThread, t]() {
+            for (long i = 0; i < opsPerThread; ++i) op(t, i);
+        });
+    }
+    for (auto& t : threads) t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return numThreads * opsPerThread / seconds;
+}
+
+// Many small protected objects, random access: cache density matters
+template <typename Mutex>
+double manyCounters(std::size_t numCounters, unsigned numThreads, long opsPerThread, long& total) {
+    std::unique_ptr<SafeCounter<Mutex>[]> counters(new SafeCounter<Mutex>[numCounters]);
+    double rate = opsPerSecond(numThreads, opsPerThread, [&counters, numCounters](unsigned t, long i) {
+        // Cheap per-thread pseudo-random index
+        std::uint64_t x = (static_cast<std::uint64_t>(i) + 1) * 0x9E3779B97F4A7C15ull + t;
+        counters[(x >> 20) % numCounters].increment();
+    });
+    total = 0;
+    for (std::size_t i = 0; i < numCounters; ++i) total += counters[i].getCount();
+    return rate;
+}
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: Memory footprint
+void demo1_footprint() {
+    std::cout << "\n=== DEMO 1: Memory Footprint ===" << std::endl;
+
+    std::cout << "type\t\t\tstd::mutex\tParkingMutex" << std::endl;
+    std::cout << "mutex\t\t\t" << sizeof(std::mutex) << "\t\t" << sizeof(ParkingMutex) << std::endl;
+    std::cout << "SafeCounter\t\t" << sizeof(SafeCounter<std::mutex>) << "\t\t"
+              << sizeof(SafeCounter<ParkingMutex>) << std::endl;
+    std::cout << "Logger3 (2 mutexes)\t" << sizeof(Logger3<std::mutex>) << "\t\t"
+              << sizeof(Logger3<ParkingMutex>) << std::endl;
+
+    const double million = 1000000.0;
+    std::cout << "1M SafeCounters:\t" << sizeof(SafeCounter<std::mutex>) * million / (1 << 20)
+              << " MB\t" << sizeof(SafeCounter<ParkingMutex>) * million / (1 << 20) << " MB" << std::endl;
+    std::cout << "SafeCounters per cache line: " << CACHE_LINE_SIZE / sizeof(SafeCounter<std::mutex>)
+              << " vs " << CACHE_LINE_SIZE / sizeof(SafeCounter<ParkingMutex>) << std::endl;
+    std::cout << "Parking lot (shared by all locks): " << sizeof(parking_lot::buckets) << " bytes" << std::endl;
+}
+
+// Demo 2: Correctness under contention (threads really park)
+void demo2_correctness() {
+    std::cout << "\n=== DEMO 2: Contended Correctness ===" << std::endl;
+
+    SafeCounter<ParkingMutex> counter;
+    ParkingMutex slow;   // held for long periods: forces parking
+    long slowSections = 0;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&counter, &slow, &slowSections]() {
+            for (int i = 0; i < 50000; ++i) counter.increment();
+            for (int i = 0; i < 5; ++i) {
+                std::lock_guard<ParkingMutex> lock(slow);
+                ++slowSections;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    std::cout << "Counter: expected 400000, got " << counter.getCount() << std::endl;
+    std::cout << "Slow sections: expected 40, got " << slowSections << std::endl;
+}
+
+// Demo 3: Throughput
+void demo3_benchmark() {
+    std::cout << "\n=== DEMO 3: Benchmark (ops/sec) ===" << std::endl;
+
+    const long ops = 1000000;
+
+    std::cout << "workload\t\t\t\tstd::mutex\tParkingMutex" << std::endl;
+
+    {
+        SafeCounter<std::mutex> a;
+        SafeCounter<ParkingMutex> b;
+        double ra = opsPerSecond(1, ops, [&a](unsigned, long) { a.increment(); });
+        double rb = opsPerSecond(1, ops, [&b](unsigned, long) { b.increment(); });
+        std::cout << "1 counter, 1 thread (uncontended)\t" << static_cast<long>(ra) << "\t"
+                  << static_cast<long>(rb) << std::endl;
+    }
+    {
+        SafeCounter<std::mutex> a;
+        SafeCounter<ParkingMutex> b;
+        double ra = opsPerSecond(4, ops, [&a](unsigned, long) { a.increment(); });
+        double rb = opsPerSecond(4, ops, [&b](unsigned, long) { b.increment(); });
+        std::cout << "1 counter, 4 threads (contended)\t" << static_cast<long>(ra) << "\t"
+                  << static_cast<long>(rb) << std::endl;
+    }
+    {
+        Logger3<std::mutex> a;
+        Logger3<ParkingMutex> b;
+        double ra = opsPerSecond(4, ops / 2, [&a](unsigned, long) { a.log(); });
+        double rb = opsPerSecond(4, ops / 2, [&b](unsigned, long) { b.log(); });
+        std::cout << "Logger3::log, 4 threads\t\t\t" << static_cast<long>(ra) << "\t"
+                  << static_cast<long>(rb) << std::endl;
+    }
+    {
+        long totalA = 0, totalB = 0;
+        double ra = manyCounters<std::mutex>(1000000, 4, ops, totalA);
+        double rb = manyCounters<ParkingMutex>(1000000, 4, ops, totalB);
+        std::cout << "1M counters, random, 4 threads\t\t" << static_cast<long>(ra) << "\t"
+                  << static_cast<long>(rb) << std::endl;
+        if (totalA != 4 * ops || totalB != 4 * ops) {
+            std::cout << "ERROR: lost increments!" << std::endl;
+        }
+    }
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== PARKING-LOT MUTEX DEMONSTRATIONS ===" << std::endl;
+
+    demo1_footprint();
+    demo2_correctness();
+    demo3_benchmark();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// DESIGN NOTES
+// ============================================================================
+/*
+WHY NO LOST WAKE-UPS:
+- park() checks "byte == LOCKED|PARKED" while holding the BUCKET lock
+- unlock() changes the byte inside unparkOne()'s callback, also under
+  the bucket lock -> a parking thread either sees the new byte (and does
+  not sleep) or is already in the queue (and gets woken)
+
+BARGING:
+- A woken thread competes with newly arriving threads for the lock
+  (it is not handed the lock directly). This keeps throughput high;
+  WebKit adds occasional direct hand-off for fairness
+
+HASH COLLISIONS:
+- Different locks can share a bucket; waiters are matched by address
+- The table here is fixed (256 buckets); production parking lots grow it
+  with the number of threads
+*/
@@ -0,0 +1,404 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+
+// ============================================================================
+// LESSON: QUEUE LOCKS (MCS AND CLH)
+// ============================================================================
+/*
+THE PROBLEM: ONE CACHE LINE, MANY WAITERS
+- With 8+ threads hammering Logger2::log or SafeLogger::log, all waiters
+  watch (and try to write) the SAME lock word
+- Every release invalidates that cache line in every waiting core, and
+  they all rush to grab it again: heavy coherence traffic
+- Who wins is random: some threads get the lock far more often than others
+
+THE SOLUTION: A QUEUE OF WAITERS, EACH SPINNING ON ITS OWN CACHE LINE
+- Every waiter brings a queue NODE (one cache line)
+- The lock itself is just a pointer to the LAST node (the tail)
+- Arriving: swap yourself in as the new tail (one atomic exchange)
+- Waiting:  spin on a flag in YOUR node (MCS) or your PREDECESSOR's node (CLH)
+            - only that one line, only you read it
+- Releasing: flip exactly ONE flag -> exactly ONE waiter wakes up
+- FIFO: the lock is handed over in arrival order
+
+MCS (Mellor-Crummey & Scott):
+    tail ──► [node C] ◄─next── [node B] ◄─next── [node A: owner]
+    A releases by setting B.locked = false  (B spins on its OWN node)
+
+CLH (Craig, Landin & Hagersten):
+    each thread spins on its PREDECESSOR's node:
+    A: owner      B: spins on A.locked      C: spins on B.locked
+    A releases by setting A.locked = false  (simpler: no 'next' pointers)
+*/
+
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Spin briefly, then give the CPU away: a waiter whose turn has come may
+// otherwise wait for a time slice behind other spinning threads
+inline void spinWait(int& spins) {
+    if (++spins < 128) {
+        cpuRelax();
+    } else {
+        std::this_thread::yield();
+    }
+}
+
+// ============================================================================
+// GOOD EXAMPLE: MCS Lock
+// ============================================================================
+class McsLock {
+public:
+    struct alignas(CACHE_LINE_SIZE) Node {
+        std::atomic<Node*> next{nullptr};
+        std::atomic<bool> locked{false};
+    };
+
+private:
+    std::atomic<Node*> tail{nullptr};
+
+public:
+    McsLock() = default;
+    McsLock(const McsLock&) = delete;
+    McsLock& operator=(const McsLock&) = delete;
+
+    void lock(Node& me) {
+        me.next.store(nullptr, std::memory_order_relaxed);
+        me.locked.store(true, std::memory_order_relaxed);
+
+        Node* prev = tail.exchange(&me, std::memory_order_acq_rel);
+        if (!prev) {
+            return;   // queue was empty: we own the lock
+        }
+        prev->next.store(&me, std::memory_order_release);   // link behind the predecessor
+
+        int spins = 0;
+        while (me.locked.load(std::memory_order_acquire)) {  // spin on OUR OWN node
+            spinWait(spins);
+        }
+    }
+
+    void unlock(Node& me) {
+        Node* succ = me.next.load(std::memory_order_acquire);
+        if (!succ) {
+            // No known successor: try to mark the queue empty
+            Node* expected = &me;
+            if (tail.compare_exchange_strong(expected, nullptr, std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+                return;
+            }
+            // A successor swapped itself in but has not linked yet: wait for it
+            int spins = 0;
+            while (!(succ = me.next.load(std::memory_order_acquire))) {
+                spinWait(spins);
+            }
+        }
+        succ->locked.store(false, std::memory_order_release);   // hand over to exactly one thread
+    }
+
+    // RAII guard: the queue node lives inside the guard (on the stack)
+    class Guard {
+    private:
+        McsLock& lockRef;
+        Node node;
+
+    public:
+        explicit Guard(McsLock& l) : lockRef(l) { lockRef.lock(node); }
+        ~Guard() { lockRef.unlock(node); }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+};
+
+// ============================================================================
+// GOOD EXAMPLE: CLH Lock
+// ============================================================================
+class ClhLock {
+public:
+    struct alignas(CACHE_LINE_SIZE) Node {
+        std::atomic<bool> locked{false};
+    };
+
+private:
+    std::atomic<Node*> tail;
+
+    // After unlock() a thread may NOT reuse its own node (the successor may
+    // still be reading it), but it may take over its predecessor's node.
+    // Free nodes are kept per thread and freed when the thread exits.
+    struct NodePool {
+        std::vector<Node*> free;
+        ~NodePool() {
+            for (Node* n : free) delete n;
+        }
+    };
+
+    static NodePool& pool() {
+        thread_local NodePool p;
+        return p;
+    }
+
+    static Node* takeNode() {
+        NodePool& p = pool();
+        if (p.free.empty()) return new Node;
+        Node* n = p.free.back();
+        p.free.pop_back();
+        return n;
+    }
+
+public:
+    ClhLock() : tail(new Node) {}   // dummy node: "previous owner already released"
+
+    ~ClhLock() { delete tail.load(); }
+
+    ClhLock(const ClhLock&) = delete;
+    ClhLock& operator=(const ClhLock&) = delete;
+
+    // Returns the predecessor node, which the caller owns after unlock()
+    Node* lock(Node* me) {
+        me->locked.store(true, std::memory_order_relaxed);
+        Node* pred = tail.exchange(me, std::memory_order_acq_rel);
+        int spins = 0;
+        while (pred->locked.load(std::memory_order_acquire)) {   // spin on the PREDECESSOR
+            spinWait(spins);
+        }
+        return pred;
+    }
+
+    void unlock(Node* me) {
+        me->locked.store(false, std::memory_order_release);   // the successor sees this
+    }
+
+    // RAII guard: carries this thread's node and its predecessor
+    class Guard {
+    private:
+        ClhLock& lockRef;
+        Node* node;
+        Node* pred;
+
+    public:
+        explicit Guard(ClhLock& l) : lockRef(l), node(takeNode()), pred(lockRef.lock(node)) {}
+
+        ~Guard() {
+            lockRef.unlock(node);
+            pool().free.push_back(pred);   // node now belongs to the successor; take pred instead
+        }
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+};
+
+// ============================================================================
+// BASELINE: std::mutex With the Same Guard Interface
+// ============================================================================
+class StdMutexLock {
+private:
+    std::mutex mtx;
+
+public:
+    class Guard {
+    private:
+        std::lock_guard<std::mutex> lock;
+
+    public:
+        explicit Guard(StdMutexLock& l) : lock(l.mtx) {}
+    };
+};
+
+// ============================================================================
+// WORKLOADS FROM demo_006.cpp AND demo_005.cpp, TEMPLATED ON THE LOCK
+// ============================================================================
+
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+NullBuffer nullBuffer;
+
+// From demo_006.cpp: two locks, always taken in the same order
+template <typename Lock>
+class Logger2 {
+    Lock mtx;
+    Lock mtx2;
+    std::ostream f{&nullBuffer};
+
+public:
+    void log(const std::string& s) {
+        typename Lock::Guard lock(mtx);    // Lock mtx first
+        typename Lock::Guard lock2(mtx2);  // Lock mtx2 second
+        f << s << std::endl;
+    }
+};
+
+// From demo_005.cpp
+template <typename Lock>
+class SafeLogger {
+    Lock mtx;
+    std::ostream logFile{&nullBuffer};
+
+public:
+    void log(const std::string& message) {
+        typename Lock::Guard lock(mtx);
+        logFile << "[" << std::this_thread::get_id() << "] " << message << std::endl;
+    }
+};
+
+// ============================================================================
+// BENCHMARK HELPER: Throughput + Fairness
+// ============================================================================
+struct Result {
+    double opsPerSec;
+    double minMaxRatio;   // least / most acquisitions of any thread (1.0 = perfectly fair)
+};
+
+// numThreads threads call op() for 'duration'; per-thread counts measure fairness
+template <typename Op>
+Result measure(unsigned numThreads, std::chrono::milliseconds duration, Op op) {
+    std::atomic<bool> go{false}, stop{false};
+    std::vector<long> counts(numThreads, 0);
+    std::vector<std::thread> threads;
+
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&go, &stop, &counts, &op, t]() {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            long n = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                op();
+                ++n;
+            }
+            counts[t] = n;
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(duration);
+    stop.store(true);
+    for (auto& t : threads) t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    long total = 0;
+    for (long c : counts) total += c;
+    auto mm = std::minmax_element(counts.begin(), counts.end());
+    double ratio = *mm.second > 0 ? static_cast<double>(*mm.first) / *mm.second : 0.0;
+    return Result{total / seconds, ratio};
+}
+
+std::string percent(double ratio) {
+    return std::to_string(static_cast<int>(ratio * 100 + 0.5)) + "%";
+}
+
+template <template <typename> class Workload>
+void benchmarkWorkload(const char* title) {
+    const std::chrono::milliseconds duration(100);
+
+    std::cout << "\n--- " << title << " ---" << std::endl;
+    std::cout << "threads\tstd::mutex\tfair\tMCS\t\tfair\tCLH\t\tfair" << std::endl;
+    for (unsigned n = 2; n <= 16; n *= 2) {
+        Workload<StdMutexLock> a;
+        Workload<McsLock> b;
+        Workload<ClhLock> c;
+        Result ra = measure(n, duration, [&a]() { a.log("T1 ---"); });
+        Result rb = measure(n, duration, [&b]() { b.log("T1 ---"); });
+        Result rc = measure(n, duration, [&c]() { c.log("T1 ---"); });
+        std::cout << n << "\t" << static_cast<long>(ra.opsPerSec) << "\t" << percent(ra.minMaxRatio) << "\t"
+                  << static_cast<long>(rb.opsPerSec) << "\t" << percent(rb.minMaxRatio) << "\t"
+                  << static_cast<long>(rc.opsPerSec) << "\t" << percent(rc.minMaxRatio) << std::endl;
+    }
+}
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: Correctness - mutual exclusion and FIFO order
+template <typename Lock>
+void checkLock(const char* name) {
+    Lock lock;
+    long counter = 0;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&lock, &counter]() {
+            for (int i = 0; i < 50000; ++i) {
+                typename Lock::Guard guard(lock);
+                ++counter;
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    std::cout << name << ": expected 200000, got " << counter << std::endl;
+}
+
+void demo1_correctness() {
+    std::cout << "\n=== DEMO 1: Mutual Exclusion (4 threads x 50000) ===" << std::endl;
+    checkLock<McsLock>("MCS");
+    checkLock<ClhLock>("CLH");
+
+    // Two queue locks held at the same time (Logger2 style)
+    Logger2<McsLock> mcsLogger;
+    Logger2<ClhLock> clhLogger;
+    mcsLogger.log("nested MCS guards");
+    clhLogger.log("nested CLH guards");
+    std::cout << "Nested guards (Logger2::log): OK" << std::endl;
+}
+
+// Demo 2: Throughput and fairness as the thread count grows
+void demo2_benchmark() {
+    std::cout << "\n=== DEMO 2: Benchmark (ops/sec; fair = min/max per-thread ops, 100% = perfectly fair) ===" << std::endl;
+
+    benchmarkWorkload<Logger2>("Logger2::log (two locks)");
+    benchmarkWorkload<SafeLogger>("SafeLogger::log");
+
+    std::cout << "\nNote: with more threads than cores a FIFO lock may hand the lock to a" << std::endl;
+    std::cout << "thread that is not running (\"lock-waiter preemption\")" << std::endl;
+    std::cout << "(hardware threads here: " << std::thread::hardware_concurrency() << ")" << std::endl;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== QUEUE LOCK (MCS / CLH) DEMONSTRATIONS ===" << std::endl;
+
+    demo1_correctness();
+    demo2_benchmark();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// MCS vs CLH vs std::mutex
+// ============================================================================
+/*
+                    std::mutex          MCS                 CLH
+Waiters spin on     (sleep in kernel)   own node            predecessor's node
+Handoff order       unspecified         FIFO                FIFO
+Release wakes       one sleeper         exactly one         exactly one
+Node memory         none                in the guard        per-thread pool
+Good on NUMA        -                   yes (local spin)    only if pred is local
+Uncontended cost    1 CAS               1 XCHG + 1 CAS      1 XCHG + 1 store
+
+Queue locks SPIN: use them when threads <= cores and critical sections
+are short. Oversubscribed systems are better served by parking locks
+(demo_022, demo_023).
+*/
@@ -0,0 +1,442 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <deque>
+#include <string>
+#include <chrono>
+#include <exception>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// ============================================================================
+// LESSON: FLAT COMBINING
+// ============================================================================
+/*
+THE PROBLEM (demo4_safe_stack in demo_005.cpp):
+- Every push() / tryPop() takes the mutex for a few nanoseconds
+- Under contention the threads mostly WAIT for each other, and the
+  stack's data (std::vector<int>) moves from core to core with the lock:
+  every operation starts with cache misses
+
+THE SOLUTION: LET ONE THREAD DO EVERYBODY'S WORK
+- Every thread has a PUBLICATION SLOT (own cache line)
+- To run an operation, a thread writes it into its slot ("request")
+- Whoever gets the lock becomes the COMBINER:
+    it scans all slots and executes EVERY pending request in one pass,
+    writing each result back into the requester's slot
+- The others simply wait until their slot says DONE - usually without
+  ever touching the lock or the data
+
+        thread A: slot[A] = push(1)  ─┐
+        thread B: slot[B] = tryPop() ─┼─► combiner (thread C):
+        thread C: slot[C] = push(7)  ─┘     push(1), tryPop(), push(7)
+                                            data stays in C's cache
+
+WHY IT IS FASTER:
+- ONE lock acquisition for a whole batch of operations
+- The data structure stays hot in the combiner's cache
+- Waiting threads spin on their OWN slot, not on the lock
+*/
+
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// ============================================================================
+// THREAD SLOT INDEX: Small, Reusable Per-Thread Numbers
+// ============================================================================
+// Each live thread gets a unique index in [0, MAX_THREADS); the index is
+// returned when the thread exits so the slot array stays small
+class ThreadSlotIndex {
+public:
+    static constexpr std::size_t MAX_THREADS = 128;
+
+private:
+    std::mutex mtx;
+    std::vector<std::size_t> freeIndices;
+    std::size_t nextIndex = 0;
+
+    struct Holder {
+        std::size_t index;
+        Holder() : index(instance().acquire()) {}
+        ~Holder() { instance().release(index); }
+    };
+
+    static ThreadSlotIndex& instance() {
+        static ThreadSlotIndex registry;
+        return registry;
+    }
+
+    std::size_t acquire() {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!freeIndices.empty()) {
+            std::size_t i = freeIndices.back();
+            freeIndices.pop_back();
+            return i;
+        }
+        if (nextIndex == MAX_THREADS) {
+            throw std::runtime_error("ThreadSlotIndex: too many threads");
+        }
+        return nextIndex++;
+    }
+
+    void release(std::size_t i) {
+        std::lock_guard<std::mutex> lock(mtx);
+        freeIndices.push_back(i);
+    }
+
+public:
+    static std::size_t current() {
+        thread_local Holder holder;
+        return holder.index;
+    }
+};
+
+// ============================================================================
+// GOOD EXAMPLE: FlatCombining<Structure>
+// ============================================================================
+// Wraps ANY sequential data structure. Operations are callables that
+// receive 'Structure&':
+//     FlatCombining<std::vector<int>> stack;
+//     stack.apply([](std::vector<int>& v) { v.push_back(42); });
+template <typename Structure>
+class FlatCombining {
+private:
+    enum : int { EMPTY = 0, PENDING = 1, DONE = 2 };
+
+    // One publication slot per thread, each on its own cache line
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        std::atomic<int> state{EMPTY};
+        void (*invoke)(void* request, Structure& data) = nullptr;   // type-erased operation
+        void* request = nullptr;                                    // lives on the requester's stack
+    };
+
+    Structure data{};                             // touched only by the combiner
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> combinerLock{false};
+    std::atomic<std::size_t> slotsInUse{0};       // highest thread index + 1 seen so far
+    Slot slots[ThreadSlotIndex::MAX_THREADS];
+
+    // Statistics (written only by the combiner)
+    std::atomic<long> passes{0};
+    std::atomic<long> combinedOps{0};
+
+    bool tryBecomeCombiner() {
+        return !combinerLock.load(std::memory_order_relaxed) &&
+               !combinerLock.exchange(true, std::memory_order_acquire);
+    }
+
+    // Execute every pending request; repeat while new requests keep arriving
+    void combine() {
+        long executed = 0;
+        for (int pass = 0; pass < 3; ++pass) {
+            long found = 0;
+            std::size_t n = slotsInUse.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < n; ++i) {
+                Slot& s = slots[i];
+                if (s.state.load(std::memory_order_acquire) != PENDING) continue;
+                s.invoke(s.request, data);
+                s.state.store(DONE, std::memory_order_release);   // requester may continue
+                ++found;
+            }
+            executed += found;
+            if (found == 0) break;
+        }
+        passes.fetch_add(1, std::memory_order_relaxed);
+        combinedOps.fetch_add(executed, std::memory_order_relaxed);
+    }
+
+    // The operation plus room for its result or exception
+    template <typename F, typename R>
+    struct Request {
+        F& op;
+        R result{};
+        std::exception_ptr error;
+
+        explicit Request(F& f) : op(f) {}
+
+        static void invoke(void* self, Structure& data) {
+            Request* r = static_cast<Request*>(self);
+            try {
+                r->result = r->op(data);
+            } catch (...) {
+                r->error = std::current_exception();   // rethrown in the requesting thread
+            }
+        }
+    };
+
+    template <typename F>
+    struct Request<F, void> {
+        F& op;
+        std::exception_ptr error;
+
+        explicit Request(F& f) : op(f) {}
+
+        static void invoke(void* self, Structure& data) {
+            Request* r = static_cast<Request*>(self);
+            try {
+                r->op(data);
+            } catch (...) {
+                r->error = std::current_exception();
+            }
+        }
+    };
+
+    template <typename Req>
+    void publishAndWait(Req& req) {
+        std::size_t index = ThreadSlotIndex::current();
+        // Make sure combiners scan far enough to see our slot
+        std::size_t seen = slotsInUse.load(std::memory_order_relaxed);
+        while (seen <= index && !slotsInUse.compare_exchange_weak(seen, index + 1)) {
+        }
+
+        Slot& mine = slots[index];
+        mine.invoke = &Req::invoke;
+        mine.request = &req;
+        mine.state.store(PENDING, std::memory_order_release);   // publish
+
+        int spins = 0;
+        while (mine.state.load(std::memory_order_acquire) != DONE) {
+            if (tryBecomeCombiner()) {
+                combine();   // executes our own request too
+                combinerLock.store(false, std::memory_order_release);
+                continue;
+            }
+            // Someone else is combining: wait on OUR slot
+            if (++spins < 64) cpuRelax();
+            else std::this_thread::yield();
+        }
+        mine.state.store(EMPTY, std::memory_order_relaxed);
+        if (req.error) std::rethrow_exception(req.error);
+    }
+
+public:
+    FlatCombining() = default;
+    FlatCombining(const FlatCombining&) = delete;
+    FlatCombining& operator=(const FlatCombining&) = delete;
+
+    // Runs op(data) exclusively - possibly on another thread - and returns its result
+    template <typename F>
+    auto apply(F op) -> std::invoke_result_t<F&, Structure&> {
+        using R = std::invoke_result_t<F&, Structure&>;
+        Request<F, R> req(op);
+        publishAndWait(req);
+        if constexpr (!std::is_void<R>::value) {
+            return std::move(req.result);
+        }
+    }
+
+    // Average number of operations executed per combining pass
+    double averageBatch() const {
+        long p = passes.load();
+        return p ? static_cast<double>(combinedOps.load()) / p : 0.0;
+    }
+};
+
+// ============================================================================
+// BASELINE: SafeStack From demo_005.cpp
+// ============================================================================
+class SafeStack {
+private:
+    mutable std::mutex mtx;
+    std::vector<int> data;
+
+public:
+    void push(int value) {
+        std::lock_guard<std::mutex> lock(mtx);
+        data.push_back(value);
+    }
+
+    bool tryPop(int& result) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (data.empty()) {
+            return false;
+        }
+        result = data.back();
+        data.pop_back();
+        return true;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return data.size();
+    }
+};
+
+// ============================================================================
+// GOOD EXAMPLE: SafeStack Interface on Top of Flat Combining
+// ============================================================================
+class CombiningStack {
+private:
+    FlatCombining<std::vector<int>> fc;
+
+public:
+    void push(int value) {
+        fc.apply([value](std::vector<int>& v) { v.push_back(value); });
+    }
+
+    bool tryPop(int& result) {
+        return fc.apply([&result](std::vector<int>& v) {
+            if (v.empty()) return false;
+            result = v.back();
+            v.pop_back();
+            return true;
+        });
+    }
+
+    size_t size() {
+        return fc.apply([](std::vector<int>& v) { return v.size(); });
+    }
+
+    double averageBatch() const { return fc.averageBatch(); }
+};
+
+// ============================================================================
+// BENCHMARK HELPER
+// ============================================================================
+// numThreads threads alternate push / tryPop (the demo4_safe_stack mix)
+template <typename Stack>
+double measureStack(Stack& stack, unsigned numThreads, int opsPerThread) {
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&stack, &go, opsPerThread]() {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            int value;
+            for (int i = 0; i < opsPerThread; ++i) {
+                if (i & 1) stack.tryPop(value);
+                else stack.push(i);
+            }
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return numThreads * opsPerThread / seconds;
+}
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: demo4_safe_stack with the combining stack
+void demo1_safe_stack() {
+    std::cout << "\n=== DEMO 1: demo4_safe_stack with Flat Combining ===" << std::endl;
+
+    CombiningStack stack;
+    long consumed = 0;
+
+    std::thread producer([&stack]() {
+        for (int i = 0; i < 100; ++i) stack.push(i);
+    });
+    std::thread consumer([&stack, &consumed]() {
+        int value;
+        while (stack.tryPop(value)) ++consumed;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        while (stack.tryPop(value)) ++consumed;
+    });
+    producer.join();
+    consumer.join();
+
+    std::cout << "Consumed " << consumed << ", remaining " << stack.size()
+              << " (total 100)" << std::endl;
+}
+
+// Demo 2: The same wrapper around other sequential structures
+void demo2_generic() {
+    std::cout << "\n=== DEMO 2: Generic over the Data Structure ===" << std::endl;
+
+    FlatCombining<long> counter;
+    FlatCombining<std::deque<int>> queue;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&counter, &queue, t]() {
+            for (int i = 0; i < 10000; ++i) {
+                counter.apply([](long& c) { ++c; });
+                queue.apply([t, i](std::deque<int>& q) { q.push_back(t * 10000 + i); });
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    std::cout << "Counter: expected 40000, got " << counter.apply([](long& c) { return c; }) << std::endl;
+    std::cout << "Queue size: expected 40000, got "
+              << queue.apply([](std::deque<int>& q) { return q.size(); }) << std::endl;
+
+    // Exceptions travel back to the requesting thread
+    try {
+        queue.apply([](std::deque<int>& q) -> int {
+            if (q.size() > 10) throw std::runtime_error("queue too long");
+            return 0;
+        });
+    } catch (const std::exception& e) {
+        std::cout << "Caught from combined operation: " << e.what() << std::endl;
+    }
+}
+
+// Demo 3: Mutex SafeStack vs CombiningStack
+void demo3_benchmark() {
+    std::cout << "\n=== DEMO 3: Benchmark (push/tryPop ops/sec) ===" << std::endl;
+
+    const int opsPerThread = 200000;
+
+    std::cout << "threads\tSafeStack\tCombiningStack\tavg batch" << std::endl;
+    for (unsigned n = 1; n <= 16; n *= 2) {
+        SafeStack mutexStack;
+        CombiningStack combiningStack;
+        double mutexRate = measureStack(mutexStack, n, opsPerThread);
+        double combiningRate = measureStack(combiningStack, n, opsPerThread);
+        std::cout << n << "\t" << static_cast<long>(mutexRate) << "\t"
+                  << static_cast<long>(combiningRate) << "\t"
+                  << combiningStack.averageBatch() << std::endl;
+    }
+
+    std::cout << "Note: batches (and the speed-up) grow with the number of cores" << std::endl;
+    std::cout << "(hardware threads here: " << std::thread::hardware_concurrency() << ")" << std::endl;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== FLAT COMBINING DEMONSTRATIONS ===" << std::endl;
+
+    demo1_safe_stack();
+    demo2_generic();
+    demo3_benchmark();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// WHEN TO USE FLAT COMBINING
+// ============================================================================
+/*
+GOOD FIT:
+- Small, hot data structures hammered by many threads (stacks, queues,
+  counters, priority queues)
+- Operations that get cheaper in batches (e.g. a push and a pop in the
+  same batch cancel out; a combiner can sort or merge requests)
+
+POOR FIT:
+- Low contention: publishing + scanning slots costs more than a mutex
+- Long operations: all waiters depend on one combiner thread
+- More threads than cores: a preempted combiner stalls everybody
+
+RULES FOR OPERATIONS:
+- They run on ANOTHER thread: no thread_local state, no thread-id
+  dependent behavior
+- Exceptions are caught and rethrown in the requesting thread
+*/
@@ -0,0 +1,629 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <chrono>
+#include <exception>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <pthread.h>
+#include <sched.h>
+
+// ============================================================================
+// LESSON: DELEGATION - ONE SERVER THREAD OWNS THE DATA
+// ============================================================================
+/*
+THE PROBLEM (SafeCounter / SafeStack in demo_005.cpp):
+- With a mutex, the critical section runs on WHICHEVER thread holds the
+  lock, so the protected data migrates between cores with the lock
+- Flat combining (demo_025.cpp) batches work, but the combiner role (and
+  the data) still wanders from thread to thread
+
+THE SOLUTION: DELEGATION
+- ONE dedicated, pinned SERVER thread owns the data structure
+- Each client has a MAILBOX: a request line and a response line, each on
+  its own cache line
+- A client writes its operation into the request line and spins on the
+  response line; the server loops over all mailboxes, executes requests
+  and publishes the results
+
+        client A ─ request ─►┐
+        client B ─ request ─►├─► server (pinned core): data always in ITS cache
+        client C ─ request ─►┘
+        client X ◄─ response ─ server
+
+THE PRICE:
+- One core is dedicated to the server, even when there is no work
+- Every operation is a round trip between two cores: slower than an
+  uncontended mutex, faster when many threads contend
+*/
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// ============================================================================
+// THREAD SLOT INDEX (as in demo_025.cpp)
+// ============================================================================
+// Per-thread index in [0, MAX_THREADS), handed back when the thread exits
+class ThreadSlotIndex {
+public:
+    static constexpr std::size_t MAX_THREADS = 128;
+
+    static std::size_t current() {
+        thread_local Holder holder;
+        return holder.index;
+    }
+
+private:
+    struct Holder {
+        std::size_t index;
+        Holder() : index(acquire()) {}
+        ~Holder() { release(index); }
+    };
+
+    static std::mutex& mtx() { static std::mutex m; return m; }
+    static std::vector<std::size_t>& freeIndices() { static std::vector<std::size_t> v; return v; }
+
+    static std::size_t acquire() {
+        static std::size_t nextIndex = 0;
+        std::lock_guard<std::mutex> lock(mtx());
+        if (!freeIndices().empty()) {
+            std::size_t i = freeIndices().back();
+            freeIndices().pop_back();
+            return i;
+        }
+        if (nextIndex == MAX_THREADS) {
+            throw std::runtime_error("ThreadSlotIndex: too many threads");
+        }
+        return nextIndex++;
+    }
+
+    static void release(std::size_t i) {
+        std::lock_guard<std::mutex> lock(mtx());
+        freeIndices().push_back(i);
+    }
+};
+
+// ============================================================================
+// OPERATION REQUEST: Shared by DelegationServer and FlatCombining
+// ============================================================================
+// The operation plus room for its result or exception. It lives on the
+// caller's stack while ANOTHER thread runs invoke()
+template <typename Structure, typename F, typename R>
+struct OpRequest {
+    F& op;
+    R result{};
+    std::exception_ptr error;
+
+    explicit OpRequest(F& f) : op(f) {}
+
+    static void invoke(void* self, Structure& data) {
+        OpRequest* r = static_cast<OpRequest*>(self);
+        try {
+            r->result = r->op(data);
+        } catch (...) {
+            r->error = std::current_exception();   // rethrown on the caller
+        }
+    }
+};
+
+template <typename Structure, typename F>
+struct OpRequest<Structure, F, void> {
+    F& op;
+    std::exception_ptr error;
+
+    explicit OpRequest(F& f) : op(f) {}
+
+    static void invoke(void* self, Structure& data) {
+        OpRequest* r = static_cast<OpRequest*>(self);
+        try {
+            r->op(data);
+        } catch (...) {
+            r->error = std::current_exception();
+        }
+    }
+};
+
+// Hands op to post(invoke, request), which returns once another thread
+// has run it; then returns the result or rethrows the exception
+template <typename Structure, typename F, typename Post>
+auto runRequest(F& op, Post post) -> std::invoke_result_t<F&, Structure&> {
+    using R = std::invoke_result_t<F&, Structure&>;
+    OpRequest<Structure, F, R> req(op);
+    post(&OpRequest<Structure, F, R>::invoke, &req);
+    if (req.error) std::rethrow_exception(req.error);
+    if constexpr (!std::is_void<R>::value) {
+        return std::move(req.result);
+    }
+}
+
+// Pins the calling thread to one CPU (Linux); returns false if not possible
+inline bool pinToCpu(unsigned cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+// ============================================================================
+// GOOD EXAMPLE: DelegationServer<Structure>
+// ============================================================================
+// Owns a Structure and a server thread. Operations are callables that
+// receive 'Structure&' and run ON THE SERVER THREAD:
+//     DelegationServer<long> counter;
+//     counter.execute([](long& c) { ++c; });
+template <typename Structure>
+class DelegationServer {
+private:
+    // Written by the client, read by the server
+    struct alignas(CACHE_LINE_SIZE) RequestLine {
+        std::atomic<unsigned> sequence{0};
+        void (*invoke)(void* request, Structure& data) = nullptr;
+        void* request = nullptr;                 // lives on the client's stack
+    };
+
+    // Written by the server, read by the client
+    struct alignas(CACHE_LINE_SIZE) ResponseLine {
+        std::atomic<unsigned> sequence{0};
+    };
+
+    struct Mailbox {
+        RequestLine request;
+        ResponseLine response;
+    };
+
+    Structure data{};                                 // touched only by the server
+    Mailbox mailboxes[ThreadSlotIndex::MAX_THREADS];
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> mailboxesInUse{0};
+    std::atomic<bool> stopping{false};
+    bool pinned = false;
+    std::thread server;
+
+    void serve(int cpu) {
+        if (cpu >= 0) pinned = pinToCpu(static_cast<unsigned>(cpu));
+        int idleScans = 0;
+        while (!stopping.load(std::memory_order_acquire)) {
+            bool worked = false;
+            std::size_t n = mailboxesInUse.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < n; ++i) {
+                Mailbox& m = mailboxes[i];
+                unsigned seq = m.request.sequence.load(std::memory_order_acquire);
+                if (seq == m.response.sequence.load(std::memory_order_relaxed)) continue;
+                m.request.invoke(m.request.request, data);
+                m.response.sequence.store(seq, std::memory_order_release);   // client may continue
+                worked = true;
+            }
+            // Idle: spin briefly, then give the core away
+            if (worked) idleScans = 0;
+            else if (++idleScans < 256) cpuRelax();
+            else std::this_thread::yield();
+        }
+    }
+
+    void postAndWait(void (*invoke)(void*, Structure&), void* request) {
+        std::size_t index = ThreadSlotIndex::current();
+        std::size_t seen = mailboxesInUse.load(std::memory_order_relaxed);
+        while (seen <= index && !mailboxesInUse.compare_exchange_weak(seen, index + 1)) {
+        }
+
+        Mailbox& m = mailboxes[index];
+        unsigned seq = m.request.sequence.load(std::memory_order_relaxed) + 1;
+        m.request.invoke = invoke;
+        m.request.request = request;
+        m.request.sequence.store(seq, std::memory_order_release);   // post
+
+        int spins = 0;
+        while (m.response.sequence.load(std::memory_order_acquire) != seq) {
+            if (++spins < 256) cpuRelax();
+            else std::this_thread::yield();   // server may need our core
+        }
+    }
+
+public:
+    // cpu < 0: do not pin the server thread
+    explicit DelegationServer(int cpu = -1) : server([this, cpu]() { serve(cpu); }) {}
+
+    ~DelegationServer() {
+        stopping.store(true, std::memory_order_release);
+        server.join();
+    }
+
+    DelegationServer(const DelegationServer&) = delete;
+    DelegationServer& operator=(const DelegationServer&) = delete;
+
+    // Runs op(data) on the server thread and returns its result
+    template <typename F>
+    auto execute(F op) -> std::invoke_result_t<F&, Structure&> {
+        return runRequest<Structure>(op, [this](auto invoke, void* request) { postAndWait(invoke, request); });
+    }
+
+    // Pinning happens on the server thread; ask through a request so the
+    // answer is synchronized
+    bool isPinned() {
+        return execute([this](Structure&) { return pinned; });
+    }
+};
+
+// Last CPU: keeps the server away from the main thread's usual core
+inline int serverCpu() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n > 1 ? static_cast<int>(n - 1) : -1;
+}
+
+// ============================================================================
+// GOOD EXAMPLE: SafeCounter / SafeStack API Over Delegation
+// ============================================================================
+class DelegatedCounter {
+private:
+    // mutable for the same reason as SafeCounter's mutex: reads are requests too
+    mutable DelegationServer<int> server{serverCpu()};
+
+public:
+    void increment() { server.execute([](int& count) { ++count; }); }
+    void decrement() { server.execute([](int& count) { --count; }); }
+    int getCount() const { return server.execute([](const int& count) { return count; }); }
+    int incrementAndGet() { return server.execute([](int& count) { return ++count; }); }
+    bool isPinned() const { return server.isPinned(); }
+};
+
+class DelegatedStack {
+private:
+    mutable DelegationServer<std::vector<int>> server{serverCpu()};
+
+public:
+    void push(int value) {
+        server.execute([value](std::vector<int>& data) { data.push_back(value); });
+    }
+
+    bool tryPop(int& result) {
+        return server.execute([&result](std::vector<int>& data) {
+            if (data.empty()) return false;
+            result = data.back();
+            data.pop_back();
+            return true;
+        });
+    }
+
+    // Throws if empty: the exception crosses from the server to the client
+    int pop() {
+        return server.execute([](std::vector<int>& data) {
+            if (data.empty()) {
+                throw std::runtime_error("Stack is empty");
+            }
+            int result = data.back();
+            data.pop_back();
+            return result;
+        });
+    }
+
+    size_t size() const {
+        return server.execute([](const std::vector<int>& data) { return data.size(); });
+    }
+
+    bool isEmpty() const { return size() == 0; }
+
+    // A COPY of the data, made on the server thread
+    std::vector<int> getAllData() const {
+        return server.execute([](const std::vector<int>& data) { return data; });
+    }
+};
+
+// ============================================================================
+// FOR COMPARISON: Minimal FlatCombining (full lesson: demo_025.cpp)
+// ============================================================================
+// One publication slot per thread; whoever grabs combinerLock runs every
+// pending request. No statistics, one scan per combining pass
+template <typename Structure>
+class FlatCombining {
+private:
+    enum : int { EMPTY = 0, PENDING = 1, DONE = 2 };
+
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        std::atomic<int> state{EMPTY};
+        void (*invoke)(void* request, Structure& data) = nullptr;
+        void* request = nullptr;
+    };
+
+    Structure data{};                             // touched only by the combiner
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> combinerLock{false};
+    std::atomic<std::size_t> slotsInUse{0};
+    Slot slots[ThreadSlotIndex::MAX_THREADS];
+
+    void publishAndWait(void (*invoke)(void*, Structure&), void* request) {
+        std::size_t index = ThreadSlotIndex::current();
+        std::size_t seen = slotsInUse.load(std::memory_order_relaxed);
+        while (seen <= index && !slotsInUse.compare_exchange_weak(seen, index + 1)) {
+        }
+
+        Slot& mine = slots[index];
+        mine.invoke = invoke;
+        mine.request = request;
+        mine.state.store(PENDING, std::memory_order_release);
+
+        int spins = 0;
+        while (mine.state.load(std::memory_order_acquire) != DONE) {
+            if (!combinerLock.load(std::memory_order_relaxed) &&
+                !combinerLock.exchange(true, std::memory_order_acquire)) {
+                std::size_t n = slotsInUse.load(std::memory_order_acquire);
+                for (std::size_t i = 0; i < n; ++i) {
+                    Slot& s = slots[i];
+                    if (s.state.load(std::memory_order_acquire) != PENDING) continue;
+                    s.invoke(s.request, data);
+                    s.state.store(DONE, std::memory_order_release);
+                }
+                combinerLock.store(false, std::memory_order_release);
+            } else if (++spins < 64) {
+                cpuRelax();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        mine.state.store(EMPTY, std::memory_order_relaxed);
+    }
+
+public:
+    FlatCombining() = default;
+    FlatCombining(const FlatCombining&) = delete;
+    FlatCombining& operator=(const FlatCombining&) = delete;
+
+    template <typename F>
+    auto apply(F op) -> std::invoke_result_t<F&, Structure&> {
+        return runRequest<Structure>(op, [this](auto invoke, void* request) { publishAndWait(invoke, request); });
+    }
+};
+
+// ============================================================================
+// BASELINES: SafeCounter / SafeStack From demo_005.cpp
+// ============================================================================
+class SafeCounter {
+private:
+    mutable std::mutex mtx;
+    int count;
+
+public:
+    SafeCounter() : count(0) {}
+
+    void increment() {
+        std::lock_guard<std::mutex> lock(mtx);
+        ++count;
+    }
+
+    int getCount() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return count;
+    }
+};
+
+class SafeStack {
+private:
+    mutable std::mutex mtx;
+    std::vector<int> data;
+
+public:
+    void push(int value) {
+        std::lock_guard<std::mutex> lock(mtx);
+        data.push_back(value);
+    }
+
+    bool tryPop(int& result) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (data.empty()) {
+            return false;
+        }
+        result = data.back();
+        data.pop_back();
+        return true;
+    }
+};
+
+// Flat-combining versions with the same interface
+class CombiningCounter {
+private:
+    mutable FlatCombining<int> fc;
+
+public:
+    void increment() { fc.apply([](int& count) { ++count; }); }
+    int getCount() const { return fc.apply([](const int& count) { return count; }); }
+};
+
+class CombiningStack {
+private:
+    FlatCombining<std::vector<int>> fc;
+
+public:
+    void push(int value) {
+        fc.apply([value](std::vector<int>& v) { v.push_back(value); });
+    }
+
+    bool tryPop(int& result) {
+        return fc.apply([&result](std::vector<int>& v) {
+            if (v.empty()) return false;
+            result = v.back();
+            v.pop_back();
+            return true;
+        });
+    }
+};
+
+// ============================================================================
+// BENCHMARK HELPERS
+// ============================================================================
+// Runs body(threadIndex) on numThreads threads; returns total ops/sec
+template <typename Body>
+double measure(unsigned numThreads, int opsPerThread, Body body) {
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&go, &body, opsPerThread]() {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            body(opsPerThread);
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return numThreads * opsPerThread / seconds;
+}
+
+template <typename Counter>
+double measureCounter(unsigned numThreads, int opsPerThread) {
+    Counter counter;
+    double rate = measure(numThreads, opsPerThread, [&counter](int ops) {
+        for (int i = 0; i < ops; ++i) counter.increment();
+    });
+    if (counter.getCount() != static_cast<int>(numThreads) * opsPerThread) {
+        std::cout << "  ERROR: lost increments!" << std::endl;
+    }
+    return rate;
+}
+
+// Alternating push / tryPop, as in demo4_safe_stack
+template <typename Stack>
+double measureStack(unsigned numThreads, int opsPerThread) {
+    Stack stack;
+    return measure(numThreads, opsPerThread, [&stack](int ops) {
+        int value;
+        for (int i = 0; i < ops; ++i) {
+            if (i & 1) stack.tryPop(value);
+            else stack.push(i);
+        }
+    });
+}
+
+// Prints one row and names the fastest of the three
+void printRow(unsigned n, double mutexRate, double combiningRate, double delegationRate) {
+    const char* best = "mutex";
+    double bestRate = mutexRate;
+    if (combiningRate > bestRate) { best = "combining"; bestRate = combiningRate; }
+    if (delegationRate > bestRate) { best = "delegation"; }
+    std::cout << n << "\t" << static_cast<long>(mutexRate) << "\t\t"
+              << static_cast<long>(combiningRate) << "\t\t"
+              << static_cast<long>(delegationRate) << "\t\t" << best << std::endl;
+}
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: SafeCounter API, state owned by the server thread
+void demo1_counter() {
+    std::cout << "\n=== DEMO 1: DelegatedCounter ===" << std::endl;
+
+    DelegatedCounter counter;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&counter]() {
+            for (int i = 0; i < 10000; ++i) counter.increment();
+            for (int i = 0; i < 2500; ++i) counter.decrement();
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    std::cout << "Expected 30000, got " << counter.getCount() << std::endl;
+    std::cout << "incrementAndGet() returns " << counter.incrementAndGet() << std::endl;
+    std::cout << "Server thread pinned: " << (counter.isPinned() ? "yes" : "no") << std::endl;
+}
+
+// Demo 2: demo4_safe_stack on a DelegatedStack
+void demo2_stack() {
+    std::cout << "\n=== DEMO 2: DelegatedStack (demo4_safe_stack) ===" << std::endl;
+
+    DelegatedStack stack;
+    long consumed = 0;
+
+    std::thread producer([&stack]() {
+        for (int i = 0; i < 100; ++i) stack.push(i);
+    });
+    std::thread consumer([&stack, &consumed]() {
+        int value;
+        while (stack.tryPop(value)) ++consumed;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        while (stack.tryPop(value)) ++consumed;
+    });
+    producer.join();
+    consumer.join();
+
+    std::cout << "Consumed " << consumed << ", remaining " << stack.size() << " (total 100)" << std::endl;
+
+    stack.push(1);
+    stack.push(2);
+    std::vector<int> copy = stack.getAllData();
+    std::cout << "getAllData() copied " << copy.size() << " items" << std::endl;
+    int value;
+    while (stack.tryPop(value)) {
+    }
+
+    try {
+        stack.pop();
+    } catch (const std::exception& e) {
+        std::cout << "pop() on empty stack threw on the client: " << e.what() << std::endl;
+    }
+}
+
+// Demo 3: Where does delegation win?
+void demo3_crossover() {
+    std::cout << "\n=== DEMO 3: Throughput Crossover (ops/sec) ===" << std::endl;
+
+    const int opsPerThread = 20000;
+
+    std::cout << "--- SafeCounter::increment ---" << std::endl;
+    std::cout << "threads\tmutex\t\tcombining\tdelegation\tbest" << std::endl;
+    for (unsigned n = 1; n <= 16; n *= 2) {
+        printRow(n, measureCounter<SafeCounter>(n, opsPerThread),
+                 measureCounter<CombiningCounter>(n, opsPerThread),
+                 measureCounter<DelegatedCounter>(n, opsPerThread));
+    }
+
+    std::cout << "--- SafeStack push/tryPop ---" << std::endl;
+    std::cout << "threads\tmutex\t\tcombining\tdelegation\tbest" << std::endl;
+    for (unsigned n = 1; n <= 16; n *= 2) {
+        printRow(n, measureStack<SafeStack>(n, opsPerThread),
+                 measureStack<CombiningStack>(n, opsPerThread),
+                 measureStack<DelegatedStack>(n, opsPerThread));
+    }
+
+    std::cout << "Note: delegation needs a free core for the server; the crossover" << std::endl;
+    std::cout << "moves to fewer threads as the core count grows" << std::endl;
+    std::cout << "(hardware threads here: " << std::thread::hardware_concurrency() << ")" << std::endl;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== DELEGATION DEMONSTRATIONS ===" << std::endl;
+
+    demo1_counter();
+    demo2_stack();
+    demo3_crossover();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// MUTEX vs FLAT COMBINING vs DELEGATION
+// ============================================================================
+/*
+                    MUTEX           FLAT COMBINING      DELEGATION
+Who runs the op     caller          current combiner    server thread
+Data lives in       any core        any core            server's core
+Dedicated core      no              no                  YES
+Best at             low contention  medium-high         high contention,
+                                                        cores to spare
+
+RULES FOR DELEGATED OPERATIONS:
+- They run on the SERVER thread: no thread_local state
+- Keep them short: every client waits behind the current operation
+- Exceptions are caught on the server and rethrown on the client
+*/
@@ -0,0 +1,412 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <chrono>
+#include <climits>
+#include <stdexcept>
+#include <algorithm>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+// ============================================================================
+// LESSON: BLOCKING POP WITH AN EVENTCOUNT
+// ============================================================================
+/*
+THE PROBLEM (consumer in demo4_safe_stack, demo_005.cpp):
+    while (stack.tryPop(value)) { ... }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    while (stack.tryPop(value)) { ... }
+- Items pushed during the sleep wait up to 10 ms
+- Items pushed after the second drain are NEVER consumed
+- Polling in a loop instead burns CPU
+
+THE SOLUTION: waitPop() + close(), BACKED BY AN EVENTCOUNT
+- An EVENTCOUNT is a "condition variable without the mutex":
+    consumer: key = prepareWait();       // "I am about to sleep"
+              if (tryPop(v)) { cancelWait(); done }
+              wait(key);                 // sleep unless notified since prepareWait
+    producer: push(v); notify();         // skips the syscall if nobody waits
+- The epoch (futex word) changes on every notification, so a notification
+  between prepareWait() and wait() is never lost
+- Waiters enter the kernel only when the stack is REALLY empty, and
+  producers make the wake syscall only when someone REALLY waits
+*/
+
+// ============================================================================
+// FUTEX WRAPPERS
+// ============================================================================
+static_assert(sizeof(std::atomic<int>) == sizeof(int), "futex needs a plain 32-bit word");
+
+// Sleep while *addr == expected (returns at once if it already changed),
+// for at most 'timeout' if given
+inline void futexWait(std::atomic<int>& word, int expected, const timespec* timeout = nullptr) {
+    syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAIT_PRIVATE, expected, timeout, nullptr, 0);
+}
+
+inline void futexWake(std::atomic<int>& word, int count) {
+    syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+// ============================================================================
+// GOOD EXAMPLE: EventCount
+// ============================================================================
+class EventCount {
+private:
+    std::atomic<int> epoch{0};      // futex word: changes on every notification
+    std::atomic<int> waiters{0};    // threads between prepareWait() and the end of wait()
+
+    // Statistics
+    std::atomic<long> notifications{0};
+    std::atomic<long> wakeSyscalls{0};
+
+    void notify(int count) {
+        notifications.fetch_add(1, std::memory_order_relaxed);
+        // seq_cst pairs with the seq_cst increment in prepareWait(): either we
+        // see the waiter, or the waiter sees the state change we just made
+        if (waiters.load(std::memory_order_seq_cst) == 0) return;   // nobody to wake: no syscall
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        futexWake(epoch, count);
+        wakeSyscalls.fetch_add(1, std::memory_order_relaxed);
+    }
+
+public:
+    typedef int Key;
+
+    // Announce the intent to wait; re-check the condition afterwards
+    Key prepareWait() {
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        return epoch.load(std::memory_order_seq_cst);
+    }
+
+    // The condition became true after prepareWait(): do not sleep
+    void cancelWait() {
+        waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    // Sleep until notified after prepareWait() returned 'key'
+    void wait(Key key) {
+        while (epoch.load(std::memory_order_acquire) == key) {
+            futexWait(epoch, key);
+        }
+        waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    // Same as wait(), but gives up at 'deadline'; returns false on timeout
+    template <typename Clock, typename Duration>
+    bool waitUntil(Key key, const std::chrono::time_point<Clock, Duration>& deadline) {
+        bool notified = true;
+        while (epoch.load(std::memory_order_acquire) == key) {
+            auto remaining = deadline - Clock::now();
+            if (remaining <= Duration::zero()) {
+                notified = false;
+                break;
+            }
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+            timespec ts{static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000)};
+            futexWait(epoch, key, &ts);
+        }
+        waiters.fetch_sub(1, std::memory_order_seq_cst);
+        return notified;
+    }
+
+    void notifyOne() { notify(1); }
+    void notifyAll() { notify(INT_MAX); }
+
+    long notificationCount() const { return notifications.load(); }
+    long wakeSyscallCount() const { return wakeSyscalls.load(); }
+};
+
+// ============================================================================
+// GOOD EXAMPLE: SafeStack With waitPop / waitPopFor / close
+// ============================================================================
+class SafeStack {
+private:
+    mutable std::mutex mtx;
+    std::vector<int> data;
+    bool closed = false;
+    EventCount nonEmpty;    // notified on push and on close
+
+public:
+    // Throws after close(): nobody would consume the value
+    void push(int value) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (closed) {
+                throw std::runtime_error("push on closed stack");
+            }
+            data.push_back(value);
+        }
+        nonEmpty.notifyOne();   // outside the lock: the woken thread can take it at once
+    }
+
+    bool tryPop(int& result) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (data.empty()) {
+            return false;
+        }
+        result = data.back();
+        data.pop_back();
+        return true;
+    }
+
+    // Blocks until an item is available; returns false once the stack is
+    // closed AND empty (remaining items are still delivered after close)
+    bool waitPop(int& result) {
+        for (;;) {
+            if (tryPop(result)) return true;
+            if (isClosed()) return false;
+
+            EventCount::Key key = nonEmpty.prepareWait();
+            // Re-check: a push between the checks above and prepareWait()
+            // did not see us waiting
+            if (tryPop(result)) {
+                nonEmpty.cancelWait();
+                return true;
+            }
+            if (isClosed()) {
+                nonEmpty.cancelWait();
+                return false;
+            }
+            nonEmpty.wait(key);
+        }
+    }
+
+    // Like waitPop(), but gives up after 'timeout'; returns false on timeout
+    // or when closed and empty
+    template <typename Rep, typename Period>
+    bool waitPopFor(int& result, const std::chrono::duration<Rep, Period>& timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (;;) {
+            if (tryPop(result)) return true;
+            if (isClosed()) return false;
+
+            EventCount::Key key = nonEmpty.prepareWait();
+            if (tryPop(result)) {
+                nonEmpty.cancelWait();
+                return true;
+            }
+            if (isClosed()) {
+                nonEmpty.cancelWait();
+                return false;
+            }
+            if (!nonEmpty.waitUntil(key, deadline)) {
+                return tryPop(result);   // last chance after the timeout
+            }
+        }
+    }
+
+    // No more pushes; wakes every waiter so they can drain and return
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            closed = true;
+        }
+        nonEmpty.notifyAll();
+    }
+
+    bool isClosed() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return closed;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return data.size();
+    }
+
+    long notificationCount() const { return nonEmpty.notificationCount(); }
+    long wakeSyscallCount() const { return nonEmpty.wakeSyscallCount(); }
+};
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+long nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Demo 1: Original sleep-and-poll consumer vs waitPop, with a slow producer
+void demo1_sleep_vs_wait() {
+    std::cout << "\n=== DEMO 1: Sleep-and-Poll vs waitPop (slow producer) ===" << std::endl;
+
+    // Producer needs ~20 ms for its 100 items
+    auto producer = [](SafeStack& stack) {
+        for (int i = 0; i < 100; ++i) {
+            stack.push(i);
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        stack.close();
+    };
+
+    {
+        SafeStack stack;
+        long consumed = 0;
+        std::thread p(producer, std::ref(stack));
+        std::thread c([&stack, &consumed]() {
+            int value;
+            while (stack.tryPop(value)) ++consumed;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            while (stack.tryPop(value)) ++consumed;
+        });
+        p.join();
+        c.join();
+        std::cout << "sleep-and-poll: consumed " << consumed << ", left behind " << stack.size() << std::endl;
+    }
+
+    {
+        SafeStack stack;
+        long consumed = 0;
+        std::thread p(producer, std::ref(stack));
+        std::thread c([&stack, &consumed]() {
+            int value;
+            while (stack.waitPop(value)) ++consumed;   // returns false after close()
+        });
+        p.join();
+        c.join();
+        std::cout << "waitPop:        consumed " << consumed << ", left behind " << stack.size() << std::endl;
+    }
+}
+
+// Demo 2: Wake latency of a consumer sleeping in the kernel
+void demo2_wake_latency() {
+    std::cout << "\n=== DEMO 2: Wake Latency (consumer asleep on every push) ===" << std::endl;
+
+    const int items = 200;
+    SafeStack stack;
+    std::vector<long> pushedAt(items);
+    std::vector<long> latencyNs;
+    latencyNs.reserve(items);
+
+    std::thread consumer([&stack, &pushedAt, &latencyNs]() {
+        int value;
+        while (stack.waitPop(value)) {
+            latencyNs.push_back(nowNs() - pushedAt[value]);
+        }
+    });
+
+    for (int i = 0; i < items; ++i) {
+        std::this_thread::sleep_for(std::chrono::microseconds(500));   // consumer goes to sleep
+        pushedAt[i] = nowNs();
+        stack.push(i);
+    }
+    stack.close();
+    consumer.join();
+
+    std::sort(latencyNs.begin(), latencyNs.end());
+    std::cout << "items consumed: " << latencyNs.size() << " of " << items << std::endl;
+    std::cout << "push -> pop latency (us): p50 " << latencyNs[latencyNs.size() / 2] / 1000
+              << ", p99 " << latencyNs[latencyNs.size() * 99 / 100] / 1000
+              << ", max " << latencyNs.back() / 1000 << std::endl;
+    std::cout << "(sleep-and-poll: up to 10000 us)" << std::endl;
+}
+
+// Demo 3: Wake syscalls are made only while someone is waiting
+void demo3_skipped_wakes() {
+    std::cout << "\n=== DEMO 3: Producers Skip the Syscall When Nobody Waits ===" << std::endl;
+
+    const int perProducer = 100000;
+
+    // Nobody waiting: pure user-space pushes
+    {
+        SafeStack stack;
+        for (int i = 0; i < perProducer; ++i) stack.push(i);
+        std::cout << "no waiters:       " << stack.notificationCount() << " notifications, "
+                  << stack.wakeSyscallCount() << " wake syscalls" << std::endl;
+    }
+
+    // Two consumers that may fall asleep whenever the stack runs empty
+    SafeStack stack;
+    std::atomic<long> consumed{0};
+
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < 2; ++c) {
+        consumers.emplace_back([&stack, &consumed]() {
+            int value;
+            while (stack.waitPop(value)) consumed.fetch_add(1, std::memory_order_relaxed);
+        });
+    }
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 2; ++p) {
+        producers.emplace_back([&stack]() {
+            for (int i = 0; i < perProducer; ++i) stack.push(i);
+        });
+    }
+    for (auto& t : producers) t.join();
+    stack.close();
+    for (auto& t : consumers) t.join();
+
+    std::cout << "2 x 2 threads:    " << stack.notificationCount() << " notifications, "
+              << stack.wakeSyscallCount() << " wake syscalls" << std::endl;
+    std::cout << "pushed " << 2 * perProducer << ", consumed " << consumed.load() << std::endl;
+    std::cout << "(fewer syscalls when consumers keep up on free cores; hardware threads here: "
+              << std::thread::hardware_concurrency() << ")" << std::endl;
+}
+
+// Demo 4: waitPopFor
+void demo4_timeout() {
+    std::cout << "\n=== DEMO 4: waitPopFor ===" << std::endl;
+
+    SafeStack stack;
+    int value = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    bool got = stack.waitPopFor(value, std::chrono::milliseconds(20));
+    auto waitedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    std::cout << "empty stack: got=" << got << " after ~" << waitedMs << " ms" << std::endl;
+
+    std::thread late([&stack]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        stack.push(42);
+    });
+    got = stack.waitPopFor(value, std::chrono::seconds(1));
+    late.join();
+    std::cout << "late push:   got=" << got << " value=" << value << std::endl;
+
+    stack.close();
+    got = stack.waitPopFor(value, std::chrono::seconds(1));
+    std::cout << "closed:      got=" << got << " (returns at once)" << std::endl;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== EVENTCOUNT DEMONSTRATIONS ===" << std::endl;
+
+    demo1_sleep_vs_wait();
+    demo2_wake_latency();
+    demo3_skipped_wakes();
+    demo4_timeout();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// EVENTCOUNT vs CONDITION VARIABLE
+// ============================================================================
+/*
+                        condition_variable          EventCount
+Needs the data mutex    yes (wait(lock, pred))      no
+Producer without waiter notify_one() still called   one atomic load, no syscall
+Works with lock-free    no                          yes (any condition you can
+structures                                          re-check)
+
+THE PROTOCOL (never skip a step):
+    key = ec.prepareWait();
+    if (condition()) { ec.cancelWait(); return; }
+    ec.wait(key);
+    // loop: re-check the condition after waking up
+
+CLOSE / SHUTDOWN:
+- close() is part of the condition: waiters must check it too
+- Deliver remaining items after close(), THEN report "closed"
+*/
@@ -0,0 +1,312 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <initializer_list>
+
+// ============================================================================
+// LESSON: BATCH OPERATIONS AND EXECUTE-AROUND
+// ============================================================================
+/*
+THE PROBLEM (SafeStack in demo_005.cpp):
+- Every call takes the lock for ONE int:
+      for (int i = 0; i < 100; ++i) stack.push(i);   // 100 lock/unlock pairs
+- Compound logic needs SEVERAL calls, and every gap between two calls is
+  a TOCTOU window (demo3_bad_interface):
+      if (stack.size() >= 2) { a = stack.pop(); b = stack.pop(); ... }
+                              ^ another thread may pop here
+
+THE SOLUTION:
+1. BATCH APIs: one lock round trip for many items
+       stack.pushBulk(items);              // whole range, one lock
+       stack.popBulk(out, 64);             // up to 64 items, one lock
+2. EXECUTE-AROUND: the caller passes the compound logic IN, and the stack
+   runs it inside ONE critical section
+       stack.withLock([](std::vector<int>& data) { ...check and act... });
+   The data is never handed OUT, so no handle leaks (PRINCIPLE 2)
+*/
+
+// ============================================================================
+// GOOD EXAMPLE: SafeStack With Batch and Execute-Around APIs
+// ============================================================================
+class SafeStack {
+private:
+    mutable std::mutex mtx;
+    std::vector<int> data;
+
+public:
+    void push(int value) {
+        std::lock_guard<std::mutex> lock(mtx);
+        data.push_back(value);
+    }
+
+    bool tryPop(int& result) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (data.empty()) {
+            return false;
+        }
+        result = data.back();
+        data.pop_back();
+        return true;
+    }
+
+    int pop() {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (data.empty()) {
+            throw std::runtime_error("Stack is empty");
+        }
+        int result = data.back();
+        data.pop_back();
+        return result;
+    }
+
+    // Pushes [first, last) under ONE lock; the last element ends up on top
+    template <typename InputIt>
+    void pushBulk(InputIt first, InputIt last) {
+        std::lock_guard<std::mutex> lock(mtx);
+        data.insert(data.end(), first, last);
+    }
+
+    // Pushes a whole range (vector, array, ...)
+    template <typename Range>
+    void pushBulk(const Range& items) {
+        pushBulk(std::begin(items), std::end(items));
+    }
+
+    // Braced lists: stack.pushBulk({1, 2, 3}) cannot deduce Range above
+    void pushBulk(std::initializer_list<int> items) {
+        pushBulk(items.begin(), items.end());
+    }
+
+    // Pops up to maxN items (top first) into 'out' under ONE lock;
+    // returns the number of items popped
+    template <typename OutputIt>
+    size_t popBulk(OutputIt out, size_t maxN) {
+        std::lock_guard<std::mutex> lock(mtx);
+        size_t n = std::min(maxN, data.size());
+        for (size_t i = 0; i < n; ++i) {
+            *out++ = data.back();
+            data.pop_back();
+        }
+        return n;
+    }
+
+    // EXECUTE-AROUND: runs f(data) inside one critical section and returns
+    // its result. f must not keep a pointer or reference to 'data'
+    template <typename F>
+    auto withLock(F f) -> std::invoke_result_t<F&, std::vector<int>&> {
+        std::lock_guard<std::mutex> lock(mtx);
+        return f(data);
+    }
+
+    // Read-only version
+    template <typename F>
+    auto withLock(F f) const -> std::invoke_result_t<F&, const std::vector<int>&> {
+        std::lock_guard<std::mutex> lock(mtx);
+        return f(data);
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return data.size();
+    }
+
+    bool isEmpty() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return data.empty();
+    }
+};
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: demo4_safe_stack with batches
+void demo1_batched_producer_consumer() {
+    std::cout << "\n=== DEMO 1: demo4_safe_stack with pushBulk / popBulk ===" << std::endl;
+
+    SafeStack stack;
+
+    std::thread producer([&stack]() {
+        std::vector<int> items(100);
+        for (int i = 0; i < 100; ++i) items[i] = i;
+        stack.pushBulk(items);   // 1 lock round trip instead of 100
+    });
+
+    int sum = 0;
+    int rounds = 0;
+    std::vector<int> batch;
+    std::thread consumer([&stack, &sum, &rounds, &batch]() {
+        while (batch.size() < 100) {
+            if (stack.popBulk(std::back_inserter(batch), 32) > 0) ++rounds;
+            else std::this_thread::yield();
+        }
+        for (int v : batch) sum += v;
+    });
+
+    producer.join();
+    consumer.join();
+
+    std::cout << "Producer: 100 items in 1 lock round trip" << std::endl;
+    std::cout << "Consumer: " << batch.size() << " items in " << rounds
+              << " lock round trips, sum " << sum << " (expected 4950)" << std::endl;
+    std::cout << "Remaining items in stack: " << stack.size() << std::endl;
+
+    stack.pushBulk({7, 8, 9});   // braced list: also one lock round trip
+    std::cout << "After pushBulk({7, 8, 9}): " << stack.size() << " items" << std::endl;
+}
+
+// Demo 2: Compound check-and-act - several calls vs one critical section
+// "If there are at least two items, replace the top two by their sum."
+// The total sum of all items must never change.
+void demo2_toctou() {
+    std::cout << "\n=== DEMO 2: Check-and-Act in One Critical Section ===" << std::endl;
+
+    const int threads = 4;
+    const int rounds = 2000;
+
+    auto fill = [](SafeStack& stack) {
+        std::vector<int> ones(threads * rounds, 1);
+        stack.pushBulk(ones);
+    };
+    auto total = [](SafeStack& stack) {
+        return stack.withLock([](const std::vector<int>& data) {
+            long sum = 0;
+            for (int v : data) sum += v;
+            return sum;
+        });
+    };
+
+    // BAD: check and act are separate calls
+    {
+        SafeStack stack;
+        fill(stack);
+        std::atomic<int> failures{0};
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&stack, &failures]() {
+                for (int i = 0; i < rounds; ++i) {
+                    if (stack.size() >= 2) {
+                        std::this_thread::yield();          // widen the TOCTOU window
+                        int a = 0;
+                        int b = 0;
+                        if (!stack.tryPop(a) || !stack.tryPop(b)) {
+                            failures.fetch_add(1);          // checked, but gone now
+                        }
+                        if (a + b > 0) stack.push(a + b);
+                    }
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        std::cout << "separate calls: total " << total(stack) << " (expected " << threads * rounds
+                  << "), check-then-act failures " << failures.load() << std::endl;
+    }
+
+    // GOOD: the whole compound operation runs under one lock
+    {
+        SafeStack stack;
+        fill(stack);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&stack]() {
+                for (int i = 0; i < rounds; ++i) {
+                    stack.withLock([](std::vector<int>& data) {
+                        if (data.size() < 2) return;
+                        int a = data.back();
+                        data.pop_back();
+                        data.back() += a;
+                    });
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        std::cout << "withLock:       total " << total(stack) << " (expected " << threads * rounds
+                  << "), no window between check and act" << std::endl;
+    }
+}
+
+// Demo 3: Items/sec for different batch sizes
+// Each thread alternates pushBulk(batch) and popBulk(batch)
+double measureBatch(unsigned numThreads, size_t batchSize, long itemsPerThread) {
+    SafeStack stack;
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&stack, &go, batchSize, itemsPerThread]() {
+            std::vector<int> in(batchSize, 1);
+            std::vector<int> out(batchSize);
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (long done = 0; done < itemsPerThread; done += static_cast<long>(batchSize)) {
+                if (batchSize == 1) {
+                    // Baseline: the original single-item calls
+                    int value;
+                    stack.push(1);
+                    stack.tryPop(value);
+                } else {
+                    stack.pushBulk(in);
+                    stack.popBulk(out.begin(), batchSize);
+                }
+            }
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return 2.0 * numThreads * itemsPerThread / seconds;   // pushed + popped
+}
+
+void demo3_benchmark() {
+    std::cout << "\n=== DEMO 3: Benchmark (items/sec, 4 threads push+pop) ===" << std::endl;
+
+    const unsigned numThreads = 4;
+    const long itemsPerThread = 1 << 20;
+
+    std::cout << "batch\titems/sec\tlock round trips/sec" << std::endl;
+    for (size_t batch = 1; batch <= 256; batch *= 2) {
+        double rate = measureBatch(numThreads, batch, itemsPerThread);
+        std::cout << batch << "\t" << static_cast<long>(rate) << "\t"
+                  << static_cast<long>(rate / batch) << std::endl;
+    }
+
+    std::cout << "Note: batch 1 uses the original push()/tryPop() calls" << std::endl;
+    std::cout << "(hardware threads here: " << std::thread::hardware_concurrency() << ")" << std::endl;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== BATCH AND EXECUTE-AROUND DEMONSTRATIONS ===" << std::endl;
+
+    demo1_batched_producer_consumer();
+    demo2_toctou();
+    demo3_benchmark();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// DESIGN GUIDELINES
+// ============================================================================
+/*
+BATCH APIs:
+- One lock round trip per batch: the lock cost is shared by all items
+- Bigger batches hold the lock longer: other threads wait longer
+  (latency vs throughput - pick batch sizes accordingly)
+
+EXECUTE-AROUND (withLock):
+- Compound operations become atomic without new member functions
+- The lambda runs UNDER the lock: keep it short, no I/O, no other locks
+  (deadlock risk, see demo_017.cpp)
+- Never let a pointer/reference to the data escape the lambda
+*/
@@ -0,0 +1,406 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <type_traits>
+#include <utility>
+
+// ============================================================================
+// LESSON: Synchronized<T, LockPolicy> - ONE WRAPPER INSTEAD OF MANY CLASSES
+// ============================================================================
+/*
+THE PROBLEM:
+- demo_005.cpp hand-writes SafeStack, SafeCounter, SafeLogger: the same
+  "private mutex + private data + lock in every method" pattern, each
+  hard-wired to std::mutex
+- demo_007.cpp's read() takes an EXCLUSIVE lock on a shared_mutex by
+  mistake: nothing in the type system stops it
+
+THE SOLUTION: Synchronized<T, LockPolicy>
+- The data can ONLY be reached through a lock:
+      Synchronized<std::vector<int>> stack;
+      stack.wlock()->push_back(42);                 // exclusive
+      size_t n = stack.rlock()->size();             // shared if possible
+      stack.withWLock([](std::vector<int>& v) { ... });
+- CONST access picks the SHARED lock automatically when the policy has
+  one (std::shared_mutex) - the demo_007 bug cannot be written
+- The lock type is a template parameter: std::mutex, std::shared_mutex,
+  SpinLock, or NullMutex (compiles away in single-threaded builds)
+- Everything is inline: same machine code as the hand-written classes
+*/
+
+// ============================================================================
+// LOCK POLICIES
+// ============================================================================
+// A policy is any type with lock()/unlock(); if it also has
+// lock_shared()/unlock_shared(), read access is shared
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Test-and-test-and-set spinlock: for very short critical sections
+class SpinLock {
+private:
+    std::atomic<bool> locked{false};
+
+public:
+    void lock() {
+        while (locked.exchange(true, std::memory_order_acquire)) {
+            while (locked.load(std::memory_order_relaxed)) cpuRelax();
+        }
+    }
+
+    bool try_lock() {
+        return !locked.load(std::memory_order_relaxed) &&
+               !locked.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock() { locked.store(false, std::memory_order_release); }
+};
+
+// Does nothing: for data that is known to be used by one thread only
+struct NullMutex {
+    void lock() {}
+    bool try_lock() { return true; }
+    void unlock() {}
+    void lock_shared() {}
+    bool try_lock_shared() { return true; }
+    void unlock_shared() {}
+};
+
+// Build-wide default: -DSINGLE_THREADED turns every default Synchronized
+// into plain data access
+#ifdef SINGLE_THREADED
+typedef NullMutex DefaultLockPolicy;
+#else
+typedef std::mutex DefaultLockPolicy;
+#endif
+
+// Compile-time check: does the policy support shared (reader) locking?
+template <typename M, typename = void>
+struct HasSharedLock : std::false_type {};
+
+template <typename M>
+struct HasSharedLock<M, std::void_t<decltype(std::declval<M&>().lock_shared()),
+                                    decltype(std::declval<M&>().unlock_shared())>>
+    : std::true_type {};
+
+// Is the argument list exactly one (possibly cv/ref-qualified) Self?
+template <typename Self, typename... Args>
+struct IsSelfArg : std::false_type {};
+
+template <typename Self, typename Arg>
+struct IsSelfArg<Self, Arg> : std::is_same<Self, std::decay_t<Arg>> {};
+
+// ============================================================================
+// GOOD EXAMPLE: LockedPtr - Access That Holds the Lock
+// ============================================================================
+// Holds the lock for as long as it lives; behaves like a pointer to the data
+template <typename T, typename Lock>
+class LockedPtr {
+private:
+    Lock lock;
+    T* ptr;
+
+public:
+    LockedPtr(typename Lock::mutex_type& m, T& data) : lock(m), ptr(&data) {}
+
+    LockedPtr(LockedPtr&&) = default;
+    LockedPtr(const LockedPtr&) = delete;
+    LockedPtr& operator=(const LockedPtr&) = delete;
+
+    T* operator->() const { return ptr; }
+    T& operator*() const { return *ptr; }
+};
+
+// ============================================================================
+// GOOD EXAMPLE: Synchronized<T, LockPolicy>
+// ============================================================================
+template <typename T, typename LockPolicy = DefaultLockPolicy>
+class Synchronized {
+public:
+    static constexpr bool hasSharedLock = HasSharedLock<LockPolicy>::value;
+
+    typedef std::unique_lock<LockPolicy> WriteLock;
+    typedef std::conditional_t<hasSharedLock, std::shared_lock<LockPolicy>,
+                               std::unique_lock<LockPolicy>> ReadLock;
+
+private:
+    mutable LockPolicy mtx;   // locked in const methods too
+    T data;
+
+public:
+    // Constrained so that it never matches Synchronized itself: a copy from
+    // a non-const lvalue must hit the deleted copy constructor below
+    template <typename... Args,
+              typename = std::enable_if_t<!IsSelfArg<Synchronized, Args...>::value>>
+    explicit Synchronized(Args&&... args) : data(std::forward<Args>(args)...) {}
+
+    // Same reasons as SafeLogger in demo_005.cpp
+    Synchronized(const Synchronized&) = delete;
+    Synchronized& operator=(const Synchronized&) = delete;
+
+    // Exclusive access
+    LockedPtr<T, WriteLock> wlock() { return LockedPtr<T, WriteLock>(mtx, data); }
+
+    // Read-only access: shared lock when the policy has one
+    LockedPtr<const T, ReadLock> rlock() const { return LockedPtr<const T, ReadLock>(mtx, data); }
+
+    // Execute-around versions (see demo_028.cpp)
+    template <typename F>
+    auto withWLock(F f) -> std::invoke_result_t<F&, T&> {
+        WriteLock lock(mtx);
+        return f(data);
+    }
+
+    template <typename F>
+    auto withRLock(F f) const -> std::invoke_result_t<F&, const T&> {
+        ReadLock lock(mtx);
+        return f(data);
+    }
+
+    // One-expression access; the lock is held until the end of the
+    // full expression. Through a const Synchronized this is a READ lock:
+    //     sync->push_back(1);                  // exclusive
+    //     std::as_const(sync)->size();         // shared
+    LockedPtr<T, WriteLock> operator->() { return wlock(); }
+    LockedPtr<const T, ReadLock> operator->() const { return rlock(); }
+
+    // Copy of the current value
+    T copy() const {
+        ReadLock lock(mtx);
+        return data;
+    }
+};
+
+// ============================================================================
+// HAND-WRITTEN CLASSES REWRITTEN WITH Synchronized
+// ============================================================================
+// SafeCounter from demo_005.cpp
+class SafeCounter {
+private:
+    mutable std::mutex mtx;
+    int count;
+
+public:
+    SafeCounter() : count(0) {}
+
+    void increment() {
+        std::lock_guard<std::mutex> lock(mtx);
+        ++count;
+    }
+
+    int getCount() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return count;
+    }
+};
+
+// The same counter in three lines, for any policy
+template <typename LockPolicy>
+class SyncCounter {
+private:
+    Synchronized<int, LockPolicy> count{0};
+
+public:
+    void increment() { ++*count.wlock(); }
+    int getCount() const { return *count.rlock(); }
+};
+
+// SafeStack from demo_005.cpp
+template <typename LockPolicy = DefaultLockPolicy>
+class SyncStack {
+private:
+    Synchronized<std::vector<int>, LockPolicy> data;
+
+public:
+    void push(int value) { data->push_back(value); }
+
+    bool tryPop(int& result) {
+        return data.withWLock([&result](std::vector<int>& v) {
+            if (v.empty()) return false;
+            result = v.back();
+            v.pop_back();
+            return true;
+        });
+    }
+
+    size_t size() const { return data->size(); }   // const: shared lock if available
+};
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: SafeStack / SafeCounter / SafeLogger without hand-written locking
+void demo1_replacing_classes() {
+    std::cout << "\n=== DEMO 1: Replacing the Hand-Written Classes ===" << std::endl;
+
+    SyncStack<> stack;
+    SyncCounter<std::mutex> counter;
+    Synchronized<std::ostringstream> logger;   // SafeLogger, writing to memory
+
+    auto worker = [&stack, &counter, &logger](int id) {
+        for (int i = 0; i < 100; ++i) {
+            stack.push(i);
+            counter.increment();
+        }
+        // The lock is held for the whole statement: one line, never torn
+        *logger.wlock() << "[worker " << id << "] done\n";
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) threads.emplace_back(worker, t);
+    for (auto& t : threads) t.join();
+
+    int value;
+    int popped = 0;
+    while (stack.tryPop(value)) ++popped;
+
+    std::cout << "stack: popped " << popped << " (expected 400)" << std::endl;
+    std::cout << "counter: " << counter.getCount() << " (expected 400)" << std::endl;
+    std::cout << "log:" << std::endl << logger.rlock()->str();
+}
+
+// Demo 2: Const access shares the lock automatically (the demo_007 bug)
+template <typename LockPolicy>
+int maxConcurrentReaders() {
+    Synchronized<std::map<int, std::string>, LockPolicy> table;
+    table.wlock()->emplace(1, "one");
+
+    std::atomic<int> active{0};
+    std::atomic<int> maxActive{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&table, &active, &maxActive]() {
+            table.withRLock([&active, &maxActive](const std::map<int, std::string>&) {
+                int now = active.fetch_add(1) + 1;
+                int seen = maxActive.load();
+                while (now > seen && !maxActive.compare_exchange_weak(seen, now)) {
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                active.fetch_sub(1);
+            });
+        });
+    }
+    for (auto& t : readers) t.join();
+    return maxActive.load();
+}
+
+void demo2_shared_readers() {
+    std::cout << "\n=== DEMO 2: Read Access Picks the Shared Lock ===" << std::endl;
+
+    std::cout << "4 readers in withRLock(), max inside at the same time:" << std::endl;
+    std::cout << "  std::mutex:        " << maxConcurrentReaders<std::mutex>() << std::endl;
+    std::cout << "  std::shared_mutex: " << maxConcurrentReaders<std::shared_mutex>() << std::endl;
+    std::cout << "  SpinLock:          " << maxConcurrentReaders<SpinLock>() << std::endl;
+    std::cout << "Readers never need to choose the lock type: rlock()/withRLock()" << std::endl;
+    std::cout << "get a shared_lock exactly when the policy supports it." << std::endl;
+}
+
+// Demo 3: Policies at compile time
+template <typename LockPolicy>
+void printPolicy(const char* name) {
+    std::cout << name << "\t" << sizeof(Synchronized<int, LockPolicy>) << "\t"
+              << (Synchronized<int, LockPolicy>::hasSharedLock ? "shared" : "exclusive") << std::endl;
+}
+
+void demo3_policies() {
+    std::cout << "\n=== DEMO 3: Lock Policies ===" << std::endl;
+
+    std::cout << "policy\t\t\tsizeof\trlock()" << std::endl;
+    printPolicy<std::mutex>("std::mutex\t\t");
+    printPolicy<std::shared_mutex>("std::shared_mutex\t");
+    printPolicy<SpinLock>("SpinLock\t\t");
+    printPolicy<NullMutex>("NullMutex\t\t");
+    std::cout << "sizeof(SafeCounter) = " << sizeof(SafeCounter) << std::endl;
+#ifdef SINGLE_THREADED
+    std::cout << "Built with -DSINGLE_THREADED: default policy is NullMutex" << std::endl;
+#else
+    std::cout << "Default policy: std::mutex (build with -DSINGLE_THREADED for NullMutex)" << std::endl;
+#endif
+}
+
+// Demo 4: Zero overhead - hand-written vs Synchronized
+template <typename Counter>
+double nsPerIncrement(unsigned numThreads, int opsPerThread) {
+    Counter counter;
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&counter, opsPerThread]() {
+            for (int i = 0; i < opsPerThread; ++i) counter.increment();
+        });
+    }
+    for (auto& t : threads) t.join();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    if (counter.getCount() != static_cast<int>(numThreads) * opsPerThread) {
+        std::cout << "  ERROR: lost increments!" << std::endl;
+    }
+    return ns / (static_cast<double>(numThreads) * opsPerThread);
+}
+
+void demo4_zero_overhead() {
+    std::cout << "\n=== DEMO 4: Cost vs Hand-Written SafeCounter (ns/increment) ===" << std::endl;
+
+    const int ops = 2000000;
+
+    std::cout << "counter\t\t\t\t1 thread\t4 threads" << std::endl;
+    std::cout << "SafeCounter (hand-written)\t" << nsPerIncrement<SafeCounter>(1, ops) << "\t\t"
+              << nsPerIncrement<SafeCounter>(4, ops / 4) << std::endl;
+    std::cout << "Synchronized<int, mutex>\t" << nsPerIncrement<SyncCounter<std::mutex>>(1, ops) << "\t\t"
+              << nsPerIncrement<SyncCounter<std::mutex>>(4, ops / 4) << std::endl;
+    std::cout << "Synchronized<int, SpinLock>\t" << nsPerIncrement<SyncCounter<SpinLock>>(1, ops) << "\t\t"
+              << nsPerIncrement<SyncCounter<SpinLock>>(4, ops / 4) << std::endl;
+    std::cout << "Synchronized<int, NullMutex>\t" << nsPerIncrement<SyncCounter<NullMutex>>(1, ops)
+              << "\t\t(single thread only)" << std::endl;
+    std::cout << "(hardware threads here: " << std::thread::hardware_concurrency() << ")" << std::endl;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== SYNCHRONIZED<T> DEMONSTRATIONS ===" << std::endl;
+
+    demo1_replacing_classes();
+    demo2_shared_readers();
+    demo3_policies();
+    demo4_zero_overhead();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// USAGE GUIDELINES
+// ============================================================================
+/*
+PICKING A POLICY:
+    std::mutex          default; general purpose
+    std::shared_mutex   read-mostly data; rlock() becomes shared
+    SpinLock            tiny critical sections, threads <= cores
+    NullMutex           single-threaded code / builds (-DSINGLE_THREADED)
+
+PITFALLS:
+- Do not keep a LockedPtr around longer than needed: it HOLDS the lock
+- Two operator-> in ONE full expression: both LockedPtr temporaries are
+  alive at once, so a non-recursive policy (std::mutex) DEADLOCKS:
+      sync->push_back(sync->size());           // self-deadlock! use withWLock
+- Two operator-> in two statements: the lock is dropped in between:
+      if (sync->empty()) sync->push_back(1);   // TOCTOU! use withWLock
+- Same rule as every execute-around API: never let a reference to the
+  data escape the lambda
+*/
@@ -0,0 +1,376 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <set>
+#include <chrono>
+#include <limits>
+#include <cstdint>
+#include <type_traits>
+
+// ============================================================================
+// LESSON: ATOMIC COUNTERS AND GAUGES, TEMPLATED ON MEMORY ORDER
+// ============================================================================
+/*
+THE PROBLEM (demo_005.cpp):
+- UnsafeCounter's count++ is a read-modify-write race
+- The fix shown there is SafeCounter: a full std::mutex around one ++
+
+MOST COUNTERS NEED MUCH LESS:
+- Statistics (requests served, bytes sent): only the FINAL sum matters
+      -> one fetch_add, memory_order_relaxed
+- Counters that PUBLISH other data ("N results are ready"):
+      -> release on the writer side, acquire on the reader side
+- Sequential consistency (the std::atomic default) is only needed when
+  several atomics must be seen in one global order
+
+THE SOLUTION: AtomicCounter<T, Order> / AtomicGauge<T, Order>
+- The memory order is part of the TYPE: the choice is made (and reviewed)
+  once, not at every call site
+- Loads, stores, RMW operations and CAS failure orders are all derived
+  from that one template argument
+- Saturating variants clamp instead of wrapping around
+*/
+
+// ============================================================================
+// MEMORY ORDER HELPERS
+// ============================================================================
+// Derives the order for each kind of access from the counter's order
+struct MemoryOrders {
+    static constexpr std::memory_order load(std::memory_order o) {
+        return o == std::memory_order_relaxed ? std::memory_order_relaxed
+             : o == std::memory_order_seq_cst ? std::memory_order_seq_cst
+             : std::memory_order_acquire;
+    }
+
+    static constexpr std::memory_order store(std::memory_order o) {
+        return o == std::memory_order_relaxed ? std::memory_order_relaxed
+             : o == std::memory_order_seq_cst ? std::memory_order_seq_cst
+             : std::memory_order_release;
+    }
+
+    // CAS failure order may not be release / acq_rel
+    static constexpr std::memory_order casFailure(std::memory_order o) {
+        return load(o);
+    }
+};
+
+// ============================================================================
+// GOOD EXAMPLE: AtomicCounter<T, Order>
+// ============================================================================
+template <typename T = long, std::memory_order Order = std::memory_order_relaxed>
+class AtomicCounter {
+    static_assert(std::is_integral<T>::value, "AtomicCounter needs an integral type");
+    static_assert(Order != std::memory_order_consume, "memory_order_consume is not supported");
+
+protected:
+    static constexpr std::memory_order LOAD = MemoryOrders::load(Order);
+    static constexpr std::memory_order STORE = MemoryOrders::store(Order);
+    static constexpr std::memory_order CAS_FAIL = MemoryOrders::casFailure(Order);
+
+    std::atomic<T> value;
+
+    // Distance from 'low' up to 'high' (high > low), computed without
+    // signed overflow
+    static std::make_unsigned_t<T> room(T low, T high) {
+        typedef std::make_unsigned_t<T> U;
+        return static_cast<U>(static_cast<U>(high) - static_cast<U>(low));
+    }
+
+public:
+    explicit AtomicCounter(T initial = 0) : value(initial) {}
+
+    AtomicCounter(const AtomicCounter&) = delete;
+    AtomicCounter& operator=(const AtomicCounter&) = delete;
+
+    void increment() { value.fetch_add(1, Order); }
+    void add(T delta) { value.fetch_add(delta, Order); }
+
+    // Returns the NEW value (e.g. unique, increasing IDs)
+    T incrementAndGet() { return value.fetch_add(1, Order) + 1; }
+    T addAndGet(T delta) { return value.fetch_add(delta, Order) + delta; }
+
+    T get() const { return value.load(LOAD); }
+
+    // Sets 'desired' only if the value is still 'expected'
+    bool compareAndSet(T expected, T desired) {
+        return value.compare_exchange_strong(expected, desired, Order, CAS_FAIL);
+    }
+
+    // Adds delta (>= 0), but never goes above 'limit' (and never wraps
+    // around); returns the new value
+    T saturatingAdd(T delta, T limit = std::numeric_limits<T>::max()) {
+        T current = value.load(std::memory_order_relaxed);
+        T next;
+        do {
+            next = (current >= limit || static_cast<std::make_unsigned_t<T>>(delta) >= room(current, limit))
+                 ? limit : static_cast<T>(current + delta);
+        } while (!value.compare_exchange_weak(current, next, Order, CAS_FAIL));
+        return next;
+    }
+
+    T saturatingIncrement(T limit = std::numeric_limits<T>::max()) {
+        return saturatingAdd(1, limit);
+    }
+
+    // Increments only while below 'limit'; false if the limit was reached
+    // (e.g. "at most N connections")
+    bool tryIncrementBelow(T limit) {
+        T current = value.load(std::memory_order_relaxed);
+        do {
+            if (current >= limit) return false;
+        } while (!value.compare_exchange_weak(current, static_cast<T>(current + 1), Order, CAS_FAIL));
+        return true;
+    }
+};
+
+// ============================================================================
+// GOOD EXAMPLE: AtomicGauge<T, Order> - A Counter That Also Goes Down
+// ============================================================================
+template <typename T = long, std::memory_order Order = std::memory_order_relaxed>
+class AtomicGauge : public AtomicCounter<T, Order> {
+private:
+    typedef AtomicCounter<T, Order> Base;
+
+public:
+    explicit AtomicGauge(T initial = 0) : Base(initial) {}
+
+    void set(T v) { this->value.store(v, Base::STORE); }
+    void decrement() { this->value.fetch_sub(1, Order); }
+    void sub(T delta) { this->value.fetch_sub(delta, Order); }
+    T decrementAndGet() { return this->value.fetch_sub(1, Order) - 1; }
+
+    // Subtracts delta (>= 0), but never goes below 'floor'; returns the new value
+    T saturatingSub(T delta, T floor = std::numeric_limits<T>::min()) {
+        T current = this->value.load(std::memory_order_relaxed);
+        T next;
+        do {
+            next = (current <= floor || static_cast<std::make_unsigned_t<T>>(delta) >= Base::room(floor, current))
+                 ? floor : static_cast<T>(current - delta);
+        } while (!this->value.compare_exchange_weak(current, next, Order, Base::CAS_FAIL));
+        return next;
+    }
+
+    // Raises the gauge to 'candidate' if it is higher (high-water mark)
+    void updateMax(T candidate) {
+        T current = this->value.load(std::memory_order_relaxed);
+        while (candidate > current &&
+               !this->value.compare_exchange_weak(current, candidate, Order, Base::CAS_FAIL)) {
+        }
+    }
+};
+
+// Common choices
+typedef AtomicCounter<long, std::memory_order_relaxed> StatCounter;    // statistics
+typedef AtomicCounter<long, std::memory_order_acq_rel> PublishCounter; // "N items are ready"
+
+// ============================================================================
+// BASELINE: SafeCounter From demo_005.cpp
+// ============================================================================
+class SafeCounter {
+private:
+    mutable std::mutex mtx;
+    int count;
+
+public:
+    SafeCounter() : count(0) {}
+
+    void increment() {
+        std::lock_guard<std::mutex> lock(mtx);
+        ++count;
+    }
+
+    int getCount() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return count;
+    }
+};
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: demo_005's UnsafeCounter task, fixed with a relaxed atomic
+void demo1_unsafe_counter_fixed() {
+    std::cout << "\n=== DEMO 1: UnsafeCounter Fixed Without a Mutex ===" << std::endl;
+
+    AtomicCounter<int, std::memory_order_relaxed> counter;
+
+    auto incrementTask = [&counter]() {
+        for (int i = 0; i < 10000; ++i) {
+            counter.increment();
+        }
+    };
+
+    std::thread t1(incrementTask);
+    std::thread t2(incrementTask);
+    t1.join();
+    t2.join();
+
+    std::cout << "Expected count: 20000" << std::endl;
+    std::cout << "Actual count: " << counter.get() << std::endl;
+}
+
+// Demo 2: incrementAndGet, compareAndSet, saturating variants
+void demo2_api() {
+    std::cout << "\n=== DEMO 2: The API ===" << std::endl;
+
+    // Unique IDs from several threads
+    StatCounter nextId;
+    std::vector<std::vector<long>> ids(4);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&nextId, &ids, t]() {
+            for (int i = 0; i < 1000; ++i) ids[t].push_back(nextId.incrementAndGet());
+        });
+    }
+    for (auto& t : threads) t.join();
+    std::set<long> unique;
+    for (auto& v : ids) unique.insert(v.begin(), v.end());
+    std::cout << "incrementAndGet: " << unique.size() << " unique IDs out of 4000" << std::endl;
+
+    // compareAndSet: exactly one thread wins the initialization
+    AtomicCounter<int, std::memory_order_acq_rel> state(0);   // 0 = uninitialized
+    AtomicCounter<int, std::memory_order_relaxed> winners;
+    threads.clear();
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&state, &winners]() {
+            if (state.compareAndSet(0, 1)) winners.increment();
+        });
+    }
+    for (auto& t : threads) t.join();
+    std::cout << "compareAndSet: " << winners.get() << " of 8 threads won" << std::endl;
+
+    // Saturating: a uint8_t never wraps to 0
+    AtomicCounter<std::uint8_t> small(250);
+    std::atomic<std::uint8_t> plain(250);
+    for (int i = 0; i < 10; ++i) {
+        small.saturatingIncrement();
+        plain.fetch_add(1);
+    }
+    std::cout << "250 + 10 as uint8_t: saturating " << static_cast<int>(small.get())
+              << ", plain fetch_add " << static_cast<int>(plain.load()) << std::endl;
+
+    // Gauge with a limit: at most 3 "connections" at a time
+    AtomicGauge<int, std::memory_order_acq_rel> connections;
+    AtomicGauge<int> highWater;
+    AtomicCounter<int> rejected;
+    threads.clear();
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&connections, &highWater, &rejected]() {
+            for (int i = 0; i < 1000; ++i) {
+                if (!connections.tryIncrementBelow(3)) {
+                    rejected.increment();
+                    continue;
+                }
+                highWater.updateMax(connections.get());
+                connections.decrement();
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    std::cout << "tryIncrementBelow(3): high-water mark " << highWater.get()
+              << ", rejected " << rejected.get() << ", open now " << connections.get() << std::endl;
+
+    AtomicGauge<int> queueDepth(2);
+    std::cout << "saturatingSub(5, 0) on 2: " << queueDepth.saturatingSub(5, 0) << std::endl;
+}
+
+// Demo 3: When the order matters - a counter that publishes data
+void demo3_publication() {
+    std::cout << "\n=== DEMO 3: acq_rel Counter Publishes Results ===" << std::endl;
+
+    const int workers = 4;
+    std::vector<long> results(workers, 0);
+    PublishCounter finished;   // release on increment, acquire on get()
+
+    std::vector<std::thread> threads;
+    for (int w = 0; w < workers; ++w) {
+        threads.emplace_back([&results, &finished, w]() {
+            long sum = 0;
+            for (long i = 0; i <= 1000; ++i) sum += i * (w + 1);
+            results[w] = sum;           // plain write...
+            finished.increment();       // ...published by the release RMW
+        });
+    }
+
+    // Reader: once it sees all workers finished (acquire), the plain
+    // writes to results[] are visible - no mutex, no join needed
+    while (finished.get() != workers) std::this_thread::yield();
+    long total = 0;
+    for (long r : results) total += r;
+    std::cout << "total " << total << " (expected " << 500500L * (1 + 2 + 3 + 4) << ")" << std::endl;
+    std::cout << "With a RELAXED counter this read would be a data race." << std::endl;
+
+    for (auto& t : threads) t.join();
+}
+
+// Demo 4: seq_cst vs acq_rel vs relaxed vs mutex
+template <typename Counter>
+double measureIncrements(unsigned numThreads, int opsPerThread) {
+    Counter counter;
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&counter, &go, opsPerThread]() {
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            for (int i = 0; i < opsPerThread; ++i) counter.increment();
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return numThreads * opsPerThread / seconds;
+}
+
+void demo4_benchmark() {
+    std::cout << "\n=== DEMO 4: Benchmark (increments/sec) ===" << std::endl;
+
+    const int opsPerThread = 1000000;
+
+    std::cout << "threads\tseq_cst\t\tacq_rel\t\trelaxed\t\tSafeCounter" << std::endl;
+    for (unsigned n = 1; n <= 8; n *= 2) {
+        std::cout << n << "\t"
+                  << static_cast<long>(measureIncrements<AtomicCounter<long, std::memory_order_seq_cst>>(n, opsPerThread)) << "\t"
+                  << static_cast<long>(measureIncrements<AtomicCounter<long, std::memory_order_acq_rel>>(n, opsPerThread)) << "\t"
+                  << static_cast<long>(measureIncrements<AtomicCounter<long, std::memory_order_relaxed>>(n, opsPerThread)) << "\t"
+                  << static_cast<long>(measureIncrements<SafeCounter>(n, opsPerThread)) << std::endl;
+    }
+
+    std::cout << "Note: on x86 every atomic RMW is a LOCK-prefixed instruction, so the three" << std::endl;
+    std::cout << "orders cost the same for fetch_add; they differ for loads/stores and on ARM." << std::endl;
+    std::cout << "(hardware threads here: " << std::thread::hardware_concurrency() << ")" << std::endl;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== ATOMIC COUNTER DEMONSTRATIONS ===" << std::endl;
+
+    demo1_unsafe_counter_fixed();
+    demo2_api();
+    demo3_publication();
+    demo4_benchmark();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// CHOOSING THE MEMORY ORDER
+// ============================================================================
+/*
+relaxed     Statistics, IDs, anything where only the count itself matters.
+            Other memory is NOT ordered with the counter.
+acq_rel     The counter announces that OTHER data is ready
+            (writers: release, readers: acquire).
+seq_cst     Several atomics must be observed in one global order
+            (e.g. Dekker-style flags). The safe default - and the slowest
+            for loads/stores on weakly ordered CPUs.
+
+mutex       Only when the counter must change together with OTHER data.
+*/
@@ -0,0 +1,490 @@
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+
+// ============================================================================
+// LESSON: TAIL LATENCY WITH A CONCURRENT HDR HISTOGRAM
+// ============================================================================
+/*
+THE QUESTION:
+- How long does SafeStack::push (demo_005), SafeLogger::log (demo_005)
+  or a reader/writer in demo_007 take?
+- An AVERAGE hides what users feel: one writer holding the lock for 5 ms
+  barely moves the mean, but it IS the 99th percentile
+
+THE TOOL: AN HDR ("High Dynamic Range") HISTOGRAM
+- LOG-LINEAR buckets: every power of two is split into 32 equal
+  sub-buckets, so the error is at most ~3% whether the value is 50 ns or
+  50 seconds - with a fixed, small number of buckets
+- Percentiles (p50, p99, p99.9, max) instead of an average
+
+CONCURRENT AND CHEAP:
+- Counts are SHARDED per thread (like ProfiledMutex in demo_016.cpp):
+  recording is ONE relaxed fetch_add on the thread's own shard - no
+  lock, no allocation
+- snapshot() adds up the shards into a plain, MERGEABLE copy
+- Tracking is OPT-IN at run time (latencyTracking flag) and can be
+  compiled out completely with -DNO_LATENCY_TRACKING
+*/
+
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+// ============================================================================
+// LOG-LINEAR BUCKETS
+// ============================================================================
+// Values 0..63 get one bucket each. Above that, each power of two
+// [2^k, 2^(k+1)) is split into 32 sub-buckets of width 2^(k-5).
+// Values up to 2^41 ns (~37 minutes) are tracked; larger ones are clamped
+namespace buckets {
+    constexpr int SUB_BITS = 6;
+    constexpr std::uint64_t SUB_COUNT = 1 << SUB_BITS;   // 64
+    constexpr std::uint64_t HALF = SUB_COUNT / 2;        // 32
+    constexpr int MAX_MSB = 40;
+    constexpr std::uint64_t MAX_VALUE = (std::uint64_t(1) << (MAX_MSB + 1)) - 1;
+    constexpr std::size_t COUNT = SUB_COUNT + (MAX_MSB - SUB_BITS + 1) * HALF;
+
+    inline std::size_t indexOf(std::uint64_t v) {
+        if (v < SUB_COUNT) return static_cast<std::size_t>(v);
+        if (v > MAX_VALUE) v = MAX_VALUE;
+        int msb = 63 - __builtin_clzll(v);
+        int shift = msb - (SUB_BITS - 1);
+        return static_cast<std::size_t>(SUB_COUNT + (shift - 1) * HALF + ((v >> shift) - HALF));
+    }
+
+    // Highest value that falls into bucket i
+    inline std::uint64_t highestOf(std::size_t i) {
+        if (i < SUB_COUNT) return i;
+        std::uint64_t shift = (i - SUB_COUNT) / HALF + 1;
+        std::uint64_t mantissa = (i - SUB_COUNT) % HALF + HALF;
+        return ((mantissa + 1) << shift) - 1;
+    }
+}
+
+// ============================================================================
+// GOOD EXAMPLE: HistogramSnapshot - Plain, Mergeable Copy
+// ============================================================================
+struct HistogramSnapshot {
+    std::vector<std::uint64_t> counts = std::vector<std::uint64_t>(buckets::COUNT, 0);
+    std::uint64_t count = 0;
+    std::uint64_t max = 0;
+
+    void merge(const HistogramSnapshot& other) {
+        for (std::size_t i = 0; i < buckets::COUNT; ++i) counts[i] += other.counts[i];
+        count += other.count;
+        max = std::max(max, other.max);
+    }
+
+    // Smallest bucket bound that covers fraction q of all values
+    // (reported like HdrHistogram: the highest value of that bucket)
+    std::uint64_t percentile(double q) const {
+        if (count == 0) return 0;
+        std::uint64_t rank = static_cast<std::uint64_t>(q * static_cast<double>(count));
+        if (rank < 1) rank = 1;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < buckets::COUNT; ++i) {
+            seen += counts[i];
+            if (seen >= rank) return std::min(buckets::highestOf(i), max);
+        }
+        return max;
+    }
+
+    // Estimated from bucket midpoints (within the bucket precision)
+    double mean() const {
+        if (count == 0) return 0.0;
+        double total = 0.0;
+        for (std::size_t i = 0; i < buckets::COUNT; ++i) {
+            if (counts[i] == 0) continue;
+            std::uint64_t low = i == 0 ? 0 : buckets::highestOf(i - 1) + 1;
+            total += counts[i] * (low + buckets::highestOf(i)) / 2.0;
+        }
+        return total / count;
+    }
+
+    void print(std::ostream& out, const std::string& name) const {
+        out << std::left << std::setw(22) << name << std::right
+            << std::setw(9) << count
+            << std::setw(10) << static_cast<long>(mean())
+            << std::setw(10) << percentile(0.50)
+            << std::setw(10) << percentile(0.90)
+            << std::setw(10) << percentile(0.99)
+            << std::setw(10) << percentile(0.999)
+            << std::setw(12) << max << std::endl;
+    }
+
+    static void printHeader(std::ostream& out) {
+        out << std::left << std::setw(22) << "(ns)" << std::right
+            << std::setw(9) << "count" << std::setw(10) << "mean" << std::setw(10) << "p50"
+            << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(10) << "p99.9"
+            << std::setw(12) << "max" << std::endl;
+    }
+};
+
+// ============================================================================
+// GOOD EXAMPLE: LatencyHistogram - Concurrent Recording
+// ============================================================================
+class LatencyHistogram {
+private:
+    // Per-thread shard; counts of one shard span many cache lines, but
+    // only threads mapped to the same shard ever write them
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        std::atomic<std::uint64_t> counts[buckets::COUNT];
+        std::atomic<std::uint64_t> max{0};
+
+        Shard() {
+            for (auto& c : counts) c.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    // Allocated on the FIRST record(): a histogram that never records
+    // (tracking off, or compiled out) costs one pointer, not shards x 9 KB
+    std::atomic<Shard*> shards;
+    std::size_t shardMask;
+
+    static std::size_t threadIndex() {
+        static std::atomic<std::size_t> nextIndex{0};
+        thread_local const std::size_t index = nextIndex.fetch_add(1);
+        return index;
+    }
+
+    // Slow path, once per histogram: racing threads allocate, one wins
+    Shard* allocateShards() {
+        Shard* fresh = new Shard[shardMask + 1];
+        Shard* expected = nullptr;
+        if (shards.compare_exchange_strong(expected, fresh, std::memory_order_acq_rel)) {
+            return fresh;
+        }
+        delete[] fresh;
+        return expected;
+    }
+
+public:
+    LatencyHistogram() : shards(nullptr), shardMask(0) {
+        std::size_t n = 1;
+        while (n < std::max(4u, std::thread::hardware_concurrency())) n <<= 1;
+        shardMask = n - 1;
+    }
+
+    ~LatencyHistogram() { delete[] shards.load(std::memory_order_acquire); }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    // HOT PATH: one relaxed fetch_add (plus a CAS only for a new maximum);
+    // no lock, and no allocation after the first call
+    void record(std::uint64_t ns) {
+        Shard* all = shards.load(std::memory_order_acquire);
+        if (!all) all = allocateShards();
+        Shard& s = all[threadIndex() & shardMask];
+        s.counts[buckets::indexOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        std::uint64_t seen = s.max.load(std::memory_order_relaxed);
+        while (ns > seen && !s.max.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Adds up all shards; concurrent record() calls may or may not be included
+    HistogramSnapshot snapshot() const {
+        HistogramSnapshot snap;
+        const Shard* all = shards.load(std::memory_order_acquire);
+        if (!all) return snap;   // nothing recorded yet
+        for (std::size_t s = 0; s <= shardMask; ++s) {
+            const Shard& shard = all[s];
+            for (std::size_t i = 0; i < buckets::COUNT; ++i) {
+                std::uint64_t c = shard.counts[i].load(std::memory_order_relaxed);
+                snap.counts[i] += c;
+                snap.count += c;
+            }
+            snap.max = std::max(snap.max, shard.max.load(std::memory_order_relaxed));
+        }
+        return snap;
+    }
+};
+
+// ============================================================================
+// OPT-IN SWITCH AND SCOPED TIMER
+// ============================================================================
+// Off by default; compiled out completely with -DNO_LATENCY_TRACKING
+std::atomic<bool> latencyTracking{false};
+
+class ScopedLatency {
+#ifndef NO_LATENCY_TRACKING
+private:
+    LatencyHistogram* histogram;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedLatency(LatencyHistogram& h)
+        : histogram(latencyTracking.load(std::memory_order_relaxed) ? &h : nullptr) {
+        if (histogram) start = std::chrono::steady_clock::now();
+    }
+
+    ~ScopedLatency() {
+        if (histogram) {
+            histogram->record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count()));
+        }
+    }
+#else
+public:
+    explicit ScopedLatency(LatencyHistogram&) {}
+#endif
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+};
+
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+NullBuffer nullBuffer;
+std::ostream nullOut(&nullBuffer);
+
+// ============================================================================
+// INSTRUMENTED CLASSES FROM demo_005.cpp
+// ============================================================================
+// The timed scope starts BEFORE the lock: waiting for the lock is part of
+// the latency the caller sees
+class SafeStack {
+private:
+    mutable std::mutex mtx;
+    std::vector<int> data;
+    LatencyHistogram pushLatency;
+    LatencyHistogram popLatency;
+
+public:
+    void push(int value) {
+        ScopedLatency timer(pushLatency);
+        std::lock_guard<std::mutex> lock(mtx);
+        data.push_back(value);
+    }
+
+    bool tryPop(int& result) {
+        ScopedLatency timer(popLatency);
+        std::lock_guard<std::mutex> lock(mtx);
+        if (data.empty()) {
+            return false;
+        }
+        result = data.back();
+        data.pop_back();
+        return true;
+    }
+
+    HistogramSnapshot pushLatencySnapshot() const { return pushLatency.snapshot(); }
+    HistogramSnapshot popLatencySnapshot() const { return popLatency.snapshot(); }
+};
+
+class SafeLogger {
+private:
+    mutable std::mutex mtx;
+    std::ostream& logFile;
+    LatencyHistogram logLatency;
+
+public:
+    explicit SafeLogger(std::ostream& out) : logFile(out) {}
+
+    SafeLogger(const SafeLogger&) = delete;
+    SafeLogger& operator=(const SafeLogger&) = delete;
+
+    void log(const std::string& message) {
+        ScopedLatency timer(logLatency);
+        std::lock_guard<std::mutex> lock(mtx);
+        logFile << "[" << std::this_thread::get_id() << "] " << message << std::endl;
+    }
+
+    HistogramSnapshot latencySnapshot() const { return logLatency.snapshot(); }
+};
+
+// ============================================================================
+// INSTRUMENTED READER / WRITER FROM demo_007.cpp
+// ============================================================================
+std::shared_mutex sh_mutex;
+LatencyHistogram readLatency;
+LatencyHistogram writeLatency;
+
+// write_correct(): exclusive lock, slow write (shortened from 500 ms)
+void write_correct(int i) {
+    ScopedLatency timer(writeLatency);
+    std::unique_lock<std::shared_mutex> lock(sh_mutex);
+    nullOut << "WRITER thread " << i << " - exclusive access" << std::endl;
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+}
+
+// read_correct(): shared lock, fast read (shortened from 100 ms)
+void read_correct(int i) {
+    ScopedLatency timer(readLatency);
+    std::shared_lock<std::shared_mutex> lock(sh_mutex);
+    nullOut << "READER thread " << i << " - shared access" << std::endl;
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+}
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: Precision of log-linear buckets, percentiles, merging
+void demo1_histogram() {
+    std::cout << "\n=== DEMO 1: Log-Linear Buckets ===" << std::endl;
+
+    std::cout << buckets::COUNT << " buckets cover 0 ns .. " << buckets::MAX_VALUE / 1000000000
+              << " s (" << buckets::COUNT * sizeof(std::uint64_t) / 1024 << " KB per shard)" << std::endl;
+
+    // Two halves of 1..1,000,000, recorded separately, then merged
+    LatencyHistogram low, high;
+    for (std::uint64_t v = 1; v <= 500000; ++v) low.record(v);
+    for (std::uint64_t v = 500001; v <= 1000000; ++v) high.record(v);
+    HistogramSnapshot all = low.snapshot();
+    all.merge(high.snapshot());
+
+    std::cout << "Values 1..1000000 (two merged histograms):" << std::endl;
+    for (double q : {0.5, 0.9, 0.99, 0.999}) {
+        std::uint64_t exact = static_cast<std::uint64_t>(q * 1000000);
+        std::uint64_t reported = all.percentile(q);
+        std::cout << "  p" << q * 100 << ": exact " << exact << ", reported " << reported
+                  << " (+" << std::fixed << std::setprecision(2)
+                  << 100.0 * (static_cast<double>(reported) - exact) / exact << "%)"
+                  << std::defaultfloat << std::setprecision(6) << std::endl;
+    }
+}
+
+// Demo 2: Many threads recording into one histogram
+void demo2_concurrent_recording() {
+    std::cout << "\n=== DEMO 2: Concurrent Recording ===" << std::endl;
+
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&histogram, t]() {
+            for (std::uint64_t i = 0; i < 1000000; ++i) histogram.record(100 * (t + 1) + (i & 63));
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    HistogramSnapshot snap = histogram.snapshot();
+    std::cout << "recorded 4000000, snapshot count " << snap.count << std::endl;
+    HistogramSnapshot::printHeader(std::cout);
+    snap.print(std::cout, "synthetic");
+}
+
+// Demo 3: Tail latencies of the demo_005 / demo_007 primitives
+void demo3_instrumented() {
+    std::cout << "\n=== DEMO 3: Tail Latency of SafeStack, SafeLogger, demo_007 ===" << std::endl;
+
+#ifdef NO_LATENCY_TRACKING
+    std::cout << "Built with -DNO_LATENCY_TRACKING: nothing is recorded" << std::endl;
+#endif
+    latencyTracking.store(true);
+
+    SafeStack stack;
+    SafeLogger logger(nullOut);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&stack, &logger, t]() {
+            int value;
+            for (int i = 0; i < 50000; ++i) {
+                stack.push(i);
+                stack.tryPop(value);
+                if (i % 10 == 0) logger.log("thread " + std::to_string(t) + " message " + std::to_string(i));
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    // demo_007: readers and writers in a loop
+    threads.clear();
+    for (int r = 0; r < 5; ++r) {
+        threads.emplace_back([r]() {
+            for (int i = 0; i < 40; ++i) read_correct(r);
+        });
+    }
+    for (int w = 0; w < 2; ++w) {
+        threads.emplace_back([w]() {
+            for (int i = 0; i < 10; ++i) write_correct(w + 5);
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    latencyTracking.store(false);
+
+    HistogramSnapshot::printHeader(std::cout);
+    stack.pushLatencySnapshot().print(std::cout, "SafeStack::push");
+    stack.popLatencySnapshot().print(std::cout, "SafeStack::tryPop");
+    logger.latencySnapshot().print(std::cout, "SafeLogger::log");
+    readLatency.snapshot().print(std::cout, "read_correct");
+    writeLatency.snapshot().print(std::cout, "write_correct");
+    std::cout << "Readers wait behind 2 ms writers: look at read_correct p99 vs p50" << std::endl;
+}
+
+// Demo 4: Cost of recording
+void demo4_overhead() {
+    std::cout << "\n=== DEMO 4: Overhead ===" << std::endl;
+
+    const int ops = 5000000;
+    auto nsPerOp = [](std::chrono::steady_clock::time_point start, int n) {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / n;
+    };
+
+    LatencyHistogram histogram;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ops; ++i) histogram.record(static_cast<std::uint64_t>(i & 4095));
+    std::cout << "record():                     " << nsPerOp(start, ops) << " ns" << std::endl;
+
+    int value;
+    SafeStack off;
+    latencyTracking.store(false);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ops; ++i) {
+        off.push(i);
+        off.tryPop(value);
+    }
+    std::cout << "push+tryPop, tracking off:    " << nsPerOp(start, ops) << " ns" << std::endl;
+
+    SafeStack on;
+    latencyTracking.store(true);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ops; ++i) {
+        on.push(i);
+        on.tryPop(value);
+    }
+    latencyTracking.store(false);
+    std::cout << "push+tryPop, tracking on:     " << nsPerOp(start, ops) << " ns" << std::endl;
+    std::cout << "(tracking on = 2 clock reads + record() per call)" << std::endl;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== LATENCY HISTOGRAM DEMONSTRATIONS ===" << std::endl;
+
+    demo1_histogram();
+    demo2_concurrent_recording();
+    demo3_instrumented();
+    demo4_overhead();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// READING LATENCY HISTOGRAMS
+// ============================================================================
+/*
+- p50 is the TYPICAL call, p99 / p99.9 / max are what users complain about
+- A large gap between p50 and p99 usually means WAITING: for a lock,
+  for a writer (demo_007), for the scheduler
+- Record in nanoseconds, report in whatever unit fits: the histogram has
+  the same ~3% precision at every scale
+- Merge snapshots (per thread, per run, per machine) - never average
+  percentiles
+*/
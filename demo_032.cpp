@@ -0,0 +1,407 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+#include <pthread.h>
+#include <sched.h>
+
+// ============================================================================
+// LESSON: SINGLE-PRODUCER SINGLE-CONSUMER (SPSC) RING
+// ============================================================================
+/*
+THE PATTERN (demo_001.cpp, most of demo_002.cpp):
+- Exactly TWO threads: main and one worker
+- When they exchange data, the usual tool is a std::mutex + std::deque:
+  every item costs a lock/unlock on BOTH sides, and the lock word
+  bounces between the two cores
+
+WITH ONE PRODUCER AND ONE CONSUMER, NO LOCK AND NO RMW IS NEEDED:
+- A fixed-size ring buffer with two indices:
+      tail: written ONLY by the producer (next slot to fill)
+      head: written ONLY by the consumer (next slot to read)
+- Each side only LOADS the other side's index and STORES its own:
+  no fetch_add, no CAS, no LOCK-prefixed instruction on the fast path
+
+            head (consumer)          tail (producer)
+              v                         v
+      [ . . . A B C D E F . . . . . . . . ]   capacity = power of two
+
+CACHED INDICES:
+- The producer keeps a private copy of 'head' and re-reads the real one
+  only when the ring LOOKS full; the consumer does the same with 'tail'
+  when it LOOKS empty -> the other side's cache line is touched rarely
+- Producer and consumer fields live on SEPARATE cache lines
+
+BATCHES:
+- pushBulk/popBulk move many items with ONE index store
+*/
+
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Spin briefly, then let the other thread run (important with few cores)
+inline void backoff(int& spins) {
+    if (++spins < 64) cpuRelax();
+    else std::this_thread::yield();
+}
+
+inline bool pinToCpu(unsigned cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+// ============================================================================
+// GOOD EXAMPLE: SpscRing<T, Capacity>
+// ============================================================================
+// Exactly ONE thread may push and exactly ONE thread may pop
+template <typename T, std::size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+private:
+    static constexpr std::size_t MASK = Capacity - 1;
+
+    // Producer's cache line
+    struct alignas(CACHE_LINE_SIZE) ProducerSide {
+        std::atomic<std::size_t> tail{0};
+        std::size_t cachedHead = 0;          // private copy of consumer.head
+    };
+
+    // Consumer's cache line
+    struct alignas(CACHE_LINE_SIZE) ConsumerSide {
+        std::atomic<std::size_t> head{0};
+        std::size_t cachedTail = 0;          // private copy of producer.tail
+    };
+
+    ProducerSide producer;
+    ConsumerSide consumer;
+    alignas(CACHE_LINE_SIZE) T slots[Capacity];
+
+    // Free slots as seen by the producer; refreshes the cached head only
+    // when the ring looks too full for 'wanted' items
+    std::size_t freeSlots(std::size_t tail, std::size_t wanted) {
+        std::size_t free = Capacity - (tail - producer.cachedHead);
+        if (free < wanted) {
+            producer.cachedHead = consumer.head.load(std::memory_order_acquire);
+            free = Capacity - (tail - producer.cachedHead);
+        }
+        return free;
+    }
+
+    // Filled slots as seen by the consumer; refreshes the cached tail only
+    // when the ring looks too empty for 'wanted' items
+    std::size_t filledSlots(std::size_t head, std::size_t wanted) {
+        std::size_t filled = consumer.cachedTail - head;
+        if (filled < wanted) {
+            consumer.cachedTail = producer.tail.load(std::memory_order_acquire);
+            filled = consumer.cachedTail - head;
+        }
+        return filled;
+    }
+
+public:
+    SpscRing() = default;
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // --- Producer side ---
+    template <typename U>
+    bool tryPush(U&& value) {
+        std::size_t tail = producer.tail.load(std::memory_order_relaxed);   // we are the only writer
+        if (freeSlots(tail, 1) == 0) return false;
+        slots[tail & MASK] = std::forward<U>(value);
+        producer.tail.store(tail + 1, std::memory_order_release);          // publish the slot
+        return true;
+    }
+
+    // Pushes up to n items, published with ONE store; returns how many
+    std::size_t pushBulk(const T* items, std::size_t n) {
+        std::size_t tail = producer.tail.load(std::memory_order_relaxed);
+        n = std::min(n, freeSlots(tail, n));
+        for (std::size_t i = 0; i < n; ++i) slots[(tail + i) & MASK] = items[i];
+        producer.tail.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    // --- Consumer side ---
+    bool tryPop(T& result) {
+        std::size_t head = consumer.head.load(std::memory_order_relaxed);   // we are the only writer
+        if (filledSlots(head, 1) == 0) return false;
+        result = std::move(slots[head & MASK]);
+        consumer.head.store(head + 1, std::memory_order_release);          // hand the slot back
+        return true;
+    }
+
+    // Pops up to maxN items, released with ONE store; returns how many
+    std::size_t popBulk(T* out, std::size_t maxN) {
+        std::size_t head = consumer.head.load(std::memory_order_relaxed);
+        std::size_t n = std::min(maxN, filledSlots(head, maxN));
+        for (std::size_t i = 0; i < n; ++i) out[i] = std::move(slots[(head + i) & MASK]);
+        consumer.head.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    // Blocking helpers
+    template <typename U>
+    void push(U&& value) {
+        int spins = 0;
+        while (!tryPush(std::forward<U>(value))) backoff(spins);
+    }
+
+    T pop() {
+        T result;
+        int spins = 0;
+        while (!tryPop(result)) backoff(spins);
+        return result;
+    }
+};
+
+// ============================================================================
+// BASELINE: std::mutex + std::deque
+// ============================================================================
+template <typename T>
+class MutexQueue {
+private:
+    std::mutex mtx;
+    std::deque<T> data;
+
+public:
+    template <typename U>
+    bool tryPush(U&& value) {
+        std::lock_guard<std::mutex> lock(mtx);
+        data.push_back(std::forward<U>(value));
+        return true;
+    }
+
+    std::size_t pushBulk(const T* items, std::size_t n) {
+        std::lock_guard<std::mutex> lock(mtx);
+        data.insert(data.end(), items, items + n);
+        return n;
+    }
+
+    bool tryPop(T& result) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (data.empty()) return false;
+        result = std::move(data.front());
+        data.pop_front();
+        return true;
+    }
+
+    std::size_t popBulk(T* out, std::size_t maxN) {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::size_t n = std::min(maxN, data.size());
+        std::move(data.begin(), data.begin() + n, out);
+        data.erase(data.begin(), data.begin() + n);
+        return n;
+    }
+
+    template <typename U>
+    void push(U&& value) { tryPush(std::forward<U>(value)); }
+
+    T pop() {
+        T result;
+        int spins = 0;
+        while (!tryPop(result)) backoff(spins);
+        return result;
+    }
+};
+
+// ============================================================================
+// BENCHMARK HELPERS
+// ============================================================================
+// With 2+ CPUs the two threads are pinned to different cores
+bool pinTo(unsigned cpu) {
+    return std::thread::hardware_concurrency() >= 2 && pinToCpu(cpu);
+}
+
+// Saves the calling thread's CPU mask and restores it on scope exit:
+// the main thread is pinned only for the duration of one benchmark
+class ScopedAffinity {
+private:
+    cpu_set_t saved;
+    bool valid;
+
+public:
+    ScopedAffinity() {
+        CPU_ZERO(&saved);
+        valid = pthread_getaffinity_np(pthread_self(), sizeof(saved), &saved) == 0;
+    }
+
+    ~ScopedAffinity() {
+        if (valid) pthread_setaffinity_np(pthread_self(), sizeof(saved), &saved);
+    }
+
+    ScopedAffinity(const ScopedAffinity&) = delete;
+    ScopedAffinity& operator=(const ScopedAffinity&) = delete;
+};
+
+// Streaming: producer sends 1..items, consumer sums; returns ns/item
+template <typename Queue>
+double streamNsPerItem(std::uint64_t items, std::size_t batch) {
+    Queue queue;
+    std::uint64_t sum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread consumer([&queue, &sum, items, batch]() {
+        pinTo(1);
+        std::vector<std::uint64_t> buffer(batch);
+        std::uint64_t received = 0;
+        int spins = 0;
+        while (received < items) {
+            std::size_t n = queue.popBulk(buffer.data(), batch);
+            if (n == 0) {
+                backoff(spins);
+                continue;
+            }
+            spins = 0;
+            for (std::size_t i = 0; i < n; ++i) sum += buffer[i];
+            received += n;
+        }
+    });
+
+    ScopedAffinity restoreAffinity;
+    pinTo(0);
+    std::vector<std::uint64_t> buffer(batch);
+    int spins = 0;
+    for (std::uint64_t next = 1; next <= items;) {
+        std::size_t want = static_cast<std::size_t>(std::min<std::uint64_t>(batch, items - next + 1));
+        for (std::size_t i = 0; i < want; ++i) buffer[i] = next + i;
+        std::size_t sent = queue.pushBulk(buffer.data(), want);
+        if (sent == 0) backoff(spins);
+        else spins = 0;
+        next += sent;
+    }
+    consumer.join();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    if (sum != items * (items + 1) / 2) {
+        std::cout << "  ERROR: wrong sum!" << std::endl;
+    }
+    return ns / items;
+}
+
+// Ping-pong: main sends i, the worker echoes it back; returns ns/round trip
+template <typename Queue>
+double pingPongNs(int rounds) {
+    Queue ping, pong;
+
+    std::thread echo([&ping, &pong, rounds]() {
+        pinTo(1);
+        for (int i = 0; i < rounds; ++i) pong.push(ping.pop());
+    });
+
+    ScopedAffinity restoreAffinity;
+    pinTo(0);
+    auto start = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < static_cast<std::uint64_t>(rounds); ++i) {
+        ping.push(i);
+        if (pong.pop() != i) std::cout << "  ERROR: out of order!" << std::endl;
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    echo.join();
+    return ns / rounds;
+}
+
+typedef SpscRing<std::uint64_t, 4096> Ring;
+typedef MutexQueue<std::uint64_t> Locked;
+
+// ============================================================================
+// DEMONSTRATIONS
+// ============================================================================
+
+// Demo 1: demo_001's main + worker, exchanging messages through a ring
+void demo1_two_threads() {
+    std::cout << "\n=== DEMO 1: Worker -> Main Through an SpscRing ===" << std::endl;
+
+    SpscRing<std::string, 4> ring;   // smaller than the message count: the producer waits
+
+    std::thread t1([&ring]() {
+        for (int i = 0; i < 10; ++i) ring.push("--T1 message " + std::to_string(i));
+        ring.push(std::string("DONE"));
+    });
+
+    try {
+        for (std::string msg = ring.pop(); msg != "DONE"; msg = ring.pop()) {
+            std::cout << "MAIN got: " << msg << std::endl;
+        }
+    } catch (...) {
+        t1.join();
+        throw;
+    }
+    t1.join();
+}
+
+// Demo 2: Streaming throughput
+void demo2_streaming() {
+    std::cout << "\n=== DEMO 2: Streaming (ns/item) ===" << std::endl;
+
+    const std::uint64_t items = 5000000;
+
+    std::cout << "batch\tmutex+deque\tSpscRing" << std::endl;
+    for (std::size_t batch : {1, 8, 64, 256}) {
+        std::cout << batch << "\t" << streamNsPerItem<Locked>(items, batch) << "\t\t"
+                  << streamNsPerItem<Ring>(items, batch) << std::endl;
+    }
+}
+
+// Demo 3: Round-trip latency
+void demo3_ping_pong() {
+    std::cout << "\n=== DEMO 3: Ping-Pong (ns/round trip) ===" << std::endl;
+
+    const int rounds = 100000;
+
+    std::cout << "mutex+deque:\t" << pingPongNs<Locked>(rounds) << std::endl;
+    std::cout << "SpscRing:\t" << pingPongNs<Ring>(rounds) << std::endl;
+
+    if (std::thread::hardware_concurrency() >= 2) {
+        std::cout << "Threads pinned to CPUs 0 and 1: this is a cross-core round trip" << std::endl;
+    } else {
+        std::cout << "Only " << std::thread::hardware_concurrency()
+                  << " hardware thread: every round trip includes context switches" << std::endl;
+    }
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+int main() {
+    std::cout << "=== SPSC RING DEMONSTRATIONS ===" << std::endl;
+
+    demo1_two_threads();
+    demo2_streaming();
+    demo3_ping_pong();
+
+    std::cout << "\n=== ALL DEMONSTRATIONS COMPLETE ===" << std::endl;
+
+    return 0;
+}
+
+// ============================================================================
+// SPSC RING RULES
+// ============================================================================
+/*
+- EXACTLY one producer thread and one consumer thread. A second producer
+  (or consumer) silently corrupts the ring - use a lock or an MPMC queue
+- Capacity is fixed and a power of two (index & MASK instead of %)
+- Indices only grow; 'tail - head' is the fill level even after they
+  wrap around the size_t range
+- release store of your index <-> acquire load of the other side's index:
+  that pair is the ONLY synchronization needed
+- Batch when you can: one index store (one cache-line transfer) per batch
+*/